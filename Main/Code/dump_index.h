@@ -0,0 +1,279 @@
+#pragma once
+
+// KZI lookup index over a dump run, shared by the dumper and /Tools.
+//
+// Layout (little-endian, every table 8-byte aligned):
+//   DumpIndexHeader
+//   DumpIndexEntry[entryCount]
+//   u32 byName[entryCount]         entry indices sorted by full name
+//   u32 byShortName[shortCount]    method entries sorted by bare method name
+//   u32 byAddress[entryCount]      entry indices sorted by address
+//   char strings[stringsSize]      names, not NUL-terminated
+//
+// dumpOffset is the byte offset of the entry's class block in the
+// uncompressed dump file named in the header, or kDumpIndexNoOffset.
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr uint32_t kDumpIndexMagic = 0x31495A4B;
+constexpr uint32_t kDumpIndexVersion = 1;
+constexpr uint64_t kDumpIndexNoOffset = ~0ull;
+
+enum DumpIndexKind : uint8_t {
+    kIndexClass = 0,
+    kIndexMethod = 1,
+};
+
+struct DumpIndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t shortCount;
+    uint64_t entriesOffset;
+    uint64_t byNameOffset;
+    uint64_t byShortNameOffset;
+    uint64_t byAddressOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    char dumpName[64];
+};
+
+struct DumpIndexEntry {
+    uint64_t address;
+    uint64_t dumpOffset;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint16_t shortStart;
+    uint8_t kind;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(DumpIndexEntry) == 32, "DumpIndexEntry must stay 32 bytes");
+
+struct DumpIndexRecord {
+    std::string name;
+    uint16_t shortStart;
+    uint8_t kind;
+    uint64_t address;
+    uint64_t dumpOffset;
+};
+
+inline const char* DumpIndexKindName(uint8_t kind) {
+    switch (kind) {
+    case kIndexClass: return "Class";
+    case kIndexMethod: return "Method";
+    default: return "?";
+    }
+}
+
+inline uint64_t DumpIndexAlign(uint64_t value) {
+    return (value + 7) & ~7ull;
+}
+
+// Sorts records into the three lookup tables and writes the index file.
+inline bool WriteDumpIndex(const std::string& path, const std::string& dumpName,
+    const std::vector<DumpIndexRecord>& records) {
+    DumpIndexHeader header = {};
+    header.magic = kDumpIndexMagic;
+    header.version = kDumpIndexVersion;
+    header.entryCount = static_cast<uint32_t>(records.size());
+    std::memcpy(header.dumpName, dumpName.data(), (std::min)(dumpName.size(), sizeof(header.dumpName) - 1));
+
+    std::vector<DumpIndexEntry> entries(records.size());
+    std::string strings;
+    for (size_t i = 0; i < records.size(); i++) {
+        DumpIndexEntry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.address = records[i].address;
+        entry.dumpOffset = records[i].dumpOffset;
+        entry.nameOffset = static_cast<uint32_t>(strings.size());
+        entry.nameLength = static_cast<uint32_t>(records[i].name.size());
+        entry.shortStart = records[i].shortStart;
+        entry.kind = records[i].kind;
+        strings += records[i].name;
+    }
+
+    auto nameOf = [&](uint32_t index, bool shortName) {
+        const DumpIndexEntry& entry = entries[index];
+        uint32_t skip = shortName ? entry.shortStart : 0;
+        return std::string_view(strings.data() + entry.nameOffset + skip, entry.nameLength - skip);
+    };
+
+    std::vector<uint32_t> byName(entries.size());
+    std::vector<uint32_t> byAddress(entries.size());
+    std::vector<uint32_t> byShortName;
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        byName[i] = i;
+        byAddress[i] = i;
+        if (entries[i].kind == kIndexMethod) byShortName.push_back(i);
+    }
+
+    std::sort(byName.begin(), byName.end(), [&](uint32_t a, uint32_t b) {
+        return nameOf(a, false) < nameOf(b, false);
+    });
+    std::sort(byShortName.begin(), byShortName.end(), [&](uint32_t a, uint32_t b) {
+        return nameOf(a, true) < nameOf(b, true);
+    });
+    std::sort(byAddress.begin(), byAddress.end(), [&](uint32_t a, uint32_t b) {
+        return entries[a].address < entries[b].address;
+    });
+
+    header.shortCount = static_cast<uint32_t>(byShortName.size());
+    header.entriesOffset = DumpIndexAlign(sizeof(header));
+    header.byNameOffset = DumpIndexAlign(header.entriesOffset + entries.size() * sizeof(DumpIndexEntry));
+    header.byShortNameOffset = DumpIndexAlign(header.byNameOffset + byName.size() * sizeof(uint32_t));
+    header.byAddressOffset = DumpIndexAlign(header.byShortNameOffset + byShortName.size() * sizeof(uint32_t));
+    header.stringsOffset = DumpIndexAlign(header.byAddressOffset + byAddress.size() * sizeof(uint32_t));
+    header.stringsSize = strings.size();
+
+    std::FILE* file = nullptr;
+#ifdef _WIN32
+    if (fopen_s(&file, path.c_str(), "wb") != 0) file = nullptr;
+#else
+    file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!file) return false;
+
+    auto writeAt = [&](uint64_t offset, const void* data, size_t size) {
+        static const char zeros[8] = {};
+        long position = std::ftell(file);
+        if (position >= 0 && static_cast<uint64_t>(position) < offset) {
+            std::fwrite(zeros, 1, static_cast<size_t>(offset - position), file);
+        }
+        if (size > 0) std::fwrite(data, 1, size, file);
+    };
+
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.entriesOffset, entries.data(), entries.size() * sizeof(DumpIndexEntry));
+    writeAt(header.byNameOffset, byName.data(), byName.size() * sizeof(uint32_t));
+    writeAt(header.byShortNameOffset, byShortName.data(), byShortName.size() * sizeof(uint32_t));
+    writeAt(header.byAddressOffset, byAddress.data(), byAddress.size() * sizeof(uint32_t));
+    writeAt(header.stringsOffset, strings.data(), strings.size());
+
+    bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+// Read-only memory-mapped view of an index file.
+struct DumpIndexView {
+    MappedFile file;
+    const DumpIndexHeader* header = nullptr;
+    const DumpIndexEntry* entries = nullptr;
+    const uint32_t* byName = nullptr;
+    const uint32_t* byShortName = nullptr;
+    const uint32_t* byAddress = nullptr;
+    const char* strings = nullptr;
+
+    bool Open(const char* path) {
+        if (!file.Open(path) || file.size < sizeof(DumpIndexHeader)) {
+            Close();
+            return false;
+        }
+
+        const uint8_t* base = file.data;
+        header = reinterpret_cast<const DumpIndexHeader*>(base);
+        uint64_t entryCount = header->entryCount;
+        uint64_t tableBytes = entryCount * sizeof(uint32_t);
+        auto fits = [&](uint64_t offset, uint64_t bytes, uint64_t alignment) {
+            return offset % alignment == 0 && offset <= file.size && bytes <= file.size - offset;
+        };
+        if (header->magic != kDumpIndexMagic || header->version != kDumpIndexVersion ||
+            header->shortCount > header->entryCount ||
+            !fits(header->entriesOffset, entryCount * sizeof(DumpIndexEntry), 8) ||
+            !fits(header->byNameOffset, tableBytes, 4) ||
+            !fits(header->byShortNameOffset, uint64_t(header->shortCount) * sizeof(uint32_t), 4) ||
+            !fits(header->byAddressOffset, tableBytes, 4) ||
+            !fits(header->stringsOffset, header->stringsSize, 1)) {
+            Close();
+            return false;
+        }
+
+        entries = reinterpret_cast<const DumpIndexEntry*>(base + header->entriesOffset);
+        byName = reinterpret_cast<const uint32_t*>(base + header->byNameOffset);
+        byShortName = reinterpret_cast<const uint32_t*>(base + header->byShortNameOffset);
+        byAddress = reinterpret_cast<const uint32_t*>(base + header->byAddressOffset);
+        strings = reinterpret_cast<const char*>(base + header->stringsOffset);
+
+        // Lookups index entries and strings without further checks, so a
+        // truncated or corrupt file is rejected here as a whole.
+        for (uint64_t i = 0; i < entryCount; i++) {
+            const DumpIndexEntry& entry = entries[i];
+            if (uint64_t(entry.nameOffset) + entry.nameLength > header->stringsSize ||
+                entry.shortStart > entry.nameLength ||
+                byName[i] >= entryCount || byAddress[i] >= entryCount) {
+                Close();
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < header->shortCount; i++) {
+            if (byShortName[i] >= entryCount) {
+                Close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Close() {
+        file.Close();
+        header = nullptr;
+    }
+
+    std::string_view Name(const DumpIndexEntry& entry) const {
+        return std::string_view(strings + entry.nameOffset, entry.nameLength);
+    }
+
+    std::string_view ShortName(const DumpIndexEntry& entry) const {
+        return Name(entry).substr(entry.shortStart);
+    }
+
+    // Entries whose full name (or bare method name) equals key, or starts
+    // with it when prefix is set; fn is called in sorted order.
+    template <typename Fn>
+    size_t FindByName(std::string_view key, bool prefix, bool shortName, Fn&& fn) const {
+        const uint32_t* table = shortName ? byShortName : byName;
+        size_t count = shortName ? header->shortCount : header->entryCount;
+        auto nameOf = [&](uint32_t index) {
+            return shortName ? ShortName(entries[index]) : Name(entries[index]);
+        };
+
+        const uint32_t* first = std::lower_bound(table, table + count, key, [&](uint32_t index, std::string_view value) {
+            return nameOf(index) < value;
+        });
+
+        size_t matches = 0;
+        for (const uint32_t* it = first; it != table + count; ++it) {
+            std::string_view name = nameOf(*it);
+            bool match = prefix ? name.substr(0, key.size()) == key : name == key;
+            if (!match) break;
+            fn(entries[*it]);
+            matches++;
+        }
+        return matches;
+    }
+
+    // Entries with lo <= address <= hi, in address order.
+    template <typename Fn>
+    size_t FindByAddress(uint64_t lo, uint64_t hi, Fn&& fn) const {
+        const uint32_t* end = byAddress + header->entryCount;
+        const uint32_t* first = std::lower_bound(byAddress, end, lo, [&](uint32_t index, uint64_t value) {
+            return entries[index].address < value;
+        });
+
+        size_t matches = 0;
+        for (const uint32_t* it = first; it != end && entries[*it].address <= hi; ++it) {
+            fn(entries[*it]);
+            matches++;
+        }
+        return matches;
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+// Fixed-capacity line formatting on the stack, built on std::to_chars.
+// Nothing here allocates or touches stream state; a line that would
+// overflow is cut at capacity and flagged as truncated.
+//
+//   LineBuffer line;
+//   line << "[" << type << "] " << name << " @ " << Hex(address) << '\n';
+//   WriteFileImmediately(file, line.View());
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+struct HexArg {
+    uint64_t value;
+    bool prefix;
+};
+
+struct FixedArg {
+    double value;
+    int precision;
+};
+
+// "0x"-prefixed lowercase hex; HexDigits leaves the prefix off.
+inline HexArg Hex(uint64_t value) { return { value, true }; }
+inline HexArg Hex(const void* pointer) { return { reinterpret_cast<uintptr_t>(pointer), true }; }
+inline HexArg HexDigits(uint64_t value) { return { value, false }; }
+inline FixedArg Fixed(double value, int precision) { return { value, precision }; }
+
+template <size_t Capacity>
+struct FormatBuffer {
+    char data[Capacity];
+    size_t size = 0;
+    bool truncated = false;
+
+    void Clear() {
+        size = 0;
+        truncated = false;
+    }
+
+    std::string_view View() const { return std::string_view(data, size); }
+    std::string Str() const { return std::string(data, size); }
+
+    FormatBuffer& Append(const char* text, size_t length) {
+        size_t room = Capacity - size;
+        if (length > room) {
+            length = room;
+            truncated = true;
+        }
+        std::memcpy(data + size, text, length);
+        size += length;
+        return *this;
+    }
+
+    FormatBuffer& operator<<(std::string_view text) { return Append(text.data(), text.size()); }
+    FormatBuffer& operator<<(const char* text) { return Append(text, std::strlen(text)); }
+    FormatBuffer& operator<<(const std::string& text) { return Append(text.data(), text.size()); }
+    FormatBuffer& operator<<(char c) { return Append(&c, 1); }
+
+    template <typename Int, typename = std::enable_if_t<std::is_integral<Int>::value && !std::is_same<Int, char>::value && !std::is_same<Int, bool>::value>>
+    FormatBuffer& operator<<(Int value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        return Append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    FormatBuffer& operator<<(HexArg arg) {
+        char digits[18] = { '0', 'x' };
+        char* start = arg.prefix ? digits + 2 : digits;
+        auto result = std::to_chars(start, digits + sizeof(digits), arg.value, 16);
+        return Append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    FormatBuffer& operator<<(FixedArg arg) {
+        char digits[64];
+        auto result = std::to_chars(digits, digits + sizeof(digits), arg.value, std::chars_format::fixed, arg.precision);
+        if (result.ec != std::errc()) return Append("?", 1);
+        return Append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    template <size_t Other>
+    FormatBuffer& operator<<(const FormatBuffer<Other>& other) { return Append(other.data, other.size); }
+};
+
+// One report line or record: class headers, member lines, address entries.
+using LineBuffer = FormatBuffer<1024>;
+// A whole multi-line entry, e.g. a vector change or an address record.
+using EntryBuffer = FormatBuffer<4096>;
@@ -0,0 +1,320 @@
+#pragma once
+
+// KZF framed block format, shared by the dumper and the tools in /Tools.
+//
+// A file is a plain sequence of frames:
+//   u32 magic "KZF1" | u8 codec | u8 level | u16 reserved
+//   u32 raw size | u32 stored size | u32 FNV-1a of the raw bytes
+//   stored bytes
+// Every field is little-endian. Frames are independent, so a file that was
+// cut off mid-write is still readable up to its last complete frame.
+//
+// Payloads use the LZ4 block format. Level 1 is a single-probe greedy
+// matcher; higher levels walk a hash chain that many candidates deep and
+// trade speed for ratio. Both decode with the same decompressor.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+constexpr uint32_t kFrameMagic = 0x31465A4B;
+constexpr size_t kFrameHeaderSize = 20;
+constexpr size_t kFrameMaxRawSize = 4u << 20;
+
+enum FrameCodec : uint8_t {
+    kCodecStore = 0,
+    kCodecLz4 = 1,
+};
+
+enum FrameReadResult {
+    kFrameOk,
+    kFrameEnd,
+    kFrameTruncated,
+    kFrameCorrupt,
+};
+
+struct FrameHeader {
+    uint8_t codec;
+    uint8_t level;
+    uint32_t rawSize;
+    uint32_t storedSize;
+    uint32_t checksum;
+};
+
+inline void FrameStore32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+inline uint32_t FrameLoad32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint32_t FrameChecksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+inline size_t Lz4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+inline uint32_t Lz4Read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t Lz4Hash(uint32_t sequence, int hashLog) {
+    return (sequence * 2654435761u) >> (32 - hashLog);
+}
+
+inline uint8_t* Lz4WriteLength(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+inline uint8_t* Lz4WriteSequence(uint8_t* op, const uint8_t* literals, size_t literalLength,
+    size_t offset, size_t matchLength) {
+    uint8_t* token = op++;
+    uint8_t litNibble = literalLength >= 15 ? 15 : static_cast<uint8_t>(literalLength);
+    if (literalLength >= 15) op = Lz4WriteLength(op, literalLength - 15);
+    if (literalLength) std::memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    uint8_t matchNibble = 0;
+    if (matchLength > 0) {
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        size_t encoded = matchLength - 4;
+        matchNibble = encoded >= 15 ? 15 : static_cast<uint8_t>(encoded);
+        if (encoded >= 15) op = Lz4WriteLength(op, encoded - 15);
+    }
+
+    *token = static_cast<uint8_t>((litNibble << 4) | matchNibble);
+    return op;
+}
+
+// Compresses one block; returns the compressed size, or 0 if dst is too small.
+inline size_t Lz4CompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity, int level) {
+    constexpr size_t kMinMatch = 4;
+    constexpr size_t kLastLiterals = 5;
+    constexpr size_t kMatchFindLimit = 12;
+    constexpr size_t kMaxOffset = 65535;
+    constexpr int kHashLog = 15;
+
+    if (dstCapacity < Lz4CompressBound(srcSize)) return 0;
+
+    static thread_local std::vector<int32_t> head;
+    static thread_local std::vector<int32_t> chain;
+    head.assign(size_t(1) << kHashLog, -1);
+    if (level > 1) chain.assign(kMaxOffset + 1, -1);
+
+    int depth = level > 1 ? (1 << (level > 9 ? 9 : level)) : 1;
+    uint8_t* op = dst;
+    size_t anchor = 0;
+
+    auto insert = [&](size_t pos) {
+        uint32_t h = Lz4Hash(Lz4Read32(src + pos), kHashLog);
+        if (level > 1) chain[pos & kMaxOffset] = head[h];
+        head[h] = static_cast<int32_t>(pos);
+    };
+
+    if (srcSize > kMatchFindLimit) {
+        size_t matchLimit = srcSize - kLastLiterals;
+        size_t ipLimit = srcSize - kMatchFindLimit;
+        size_t ip = 0;
+
+        while (ip <= ipLimit) {
+            uint32_t sequence = Lz4Read32(src + ip);
+            int32_t candidate = head[Lz4Hash(sequence, kHashLog)];
+            size_t bestLength = 0;
+            size_t bestOffset = 0;
+
+            for (int probe = 0; probe < depth && candidate >= 0; probe++) {
+                size_t ref = static_cast<size_t>(candidate);
+                if (ref >= ip || ip - ref > kMaxOffset) break;
+                if (Lz4Read32(src + ref) == sequence) {
+                    size_t length = kMinMatch;
+                    while (ip + length < matchLimit && src[ref + length] == src[ip + length]) length++;
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestOffset = ip - ref;
+                    }
+                }
+                if (level <= 1) break;
+                int32_t next = chain[ref & kMaxOffset];
+                if (next >= candidate) break;
+                candidate = next;
+            }
+
+            insert(ip);
+
+            if (bestLength < kMinMatch) {
+                ip++;
+                continue;
+            }
+
+            op = Lz4WriteSequence(op, src + anchor, ip - anchor, bestOffset, bestLength);
+            if (level > 1) {
+                for (size_t pos = ip + 1; pos < ip + bestLength && pos <= ipLimit; pos++) insert(pos);
+            }
+            ip += bestLength;
+            anchor = ip;
+        }
+    }
+
+    op = Lz4WriteSequence(op, src + anchor, srcSize - anchor, 0, 0);
+    return static_cast<size_t>(op - dst);
+}
+
+inline bool Lz4DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* ipEnd = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstSize;
+
+    auto readLength = [&](size_t& length) {
+        uint8_t extra;
+        do {
+            if (ip >= ipEnd) return false;
+            extra = *ip++;
+            length += extra;
+        } while (extra == 255);
+        return true;
+    };
+
+    while (ip < ipEnd) {
+        uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(literalLength)) return false;
+        if (literalLength > static_cast<size_t>(ipEnd - ip) ||
+            literalLength > static_cast<size_t>(opEnd - op)) return false;
+        if (literalLength) std::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == ipEnd) break;
+
+        if (ipEnd - ip < 2) return false;
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(matchLength)) return false;
+        matchLength += 4;
+        if (matchLength > static_cast<size_t>(opEnd - op)) return false;
+
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < matchLength; i++) {
+            op[i] = match[i];
+        }
+        op += matchLength;
+    }
+
+    return op == opEnd;
+}
+
+// Largest frame EncodeFrameTo can produce for rawSize bytes.
+inline size_t FrameEncodedBound(size_t rawSize) {
+    return kFrameHeaderSize + Lz4CompressBound(rawSize);
+}
+
+// Writes one complete frame for raw to out, which must hold
+// FrameEncodedBound(rawSize) bytes, and returns the frame size. Falls back
+// to a stored frame when compression does not make the block smaller.
+inline size_t EncodeFrameTo(const uint8_t* raw, size_t rawSize, uint8_t codec, int level, uint8_t* out) {
+    uint8_t* header = out;
+    uint8_t* payload = header + kFrameHeaderSize;
+
+    size_t storedSize = 0;
+    if (codec == kCodecLz4) {
+        storedSize = Lz4CompressBlock(raw, rawSize, payload, Lz4CompressBound(rawSize), level);
+    }
+    if (storedSize == 0 || storedSize >= rawSize) {
+        codec = kCodecStore;
+        storedSize = rawSize;
+        if (rawSize) std::memcpy(payload, raw, rawSize);
+    }
+
+    FrameStore32(header, kFrameMagic);
+    header[4] = codec;
+    header[5] = static_cast<uint8_t>(level);
+    header[6] = 0;
+    header[7] = 0;
+    FrameStore32(header + 8, static_cast<uint32_t>(rawSize));
+    FrameStore32(header + 12, static_cast<uint32_t>(storedSize));
+    FrameStore32(header + 16, FrameChecksum(raw, rawSize));
+    return kFrameHeaderSize + storedSize;
+}
+
+// Appends one complete frame for raw to out.
+inline void EncodeFrame(const uint8_t* raw, size_t rawSize, uint8_t codec, int level, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + FrameEncodedBound(rawSize));
+    out.resize(start + EncodeFrameTo(raw, rawSize, codec, level, out.data() + start));
+}
+
+// Reads and decodes the next frame from file into raw.
+inline FrameReadResult ReadFrame(std::FILE* file, FrameHeader& header, std::vector<uint8_t>& raw) {
+    uint8_t bytes[kFrameHeaderSize];
+    size_t got = std::fread(bytes, 1, sizeof(bytes), file);
+    if (got == 0) return kFrameEnd;
+    if (got < sizeof(bytes)) return kFrameTruncated;
+    if (FrameLoad32(bytes) != kFrameMagic) return kFrameCorrupt;
+
+    header.codec = bytes[4];
+    header.level = bytes[5];
+    header.rawSize = FrameLoad32(bytes + 8);
+    header.storedSize = FrameLoad32(bytes + 12);
+    header.checksum = FrameLoad32(bytes + 16);
+    if (header.rawSize > kFrameMaxRawSize || header.storedSize > Lz4CompressBound(header.rawSize)) {
+        return kFrameCorrupt;
+    }
+
+    std::vector<uint8_t> stored(header.storedSize);
+    if (std::fread(stored.data(), 1, stored.size(), file) < stored.size()) return kFrameTruncated;
+
+    raw.resize(header.rawSize);
+    if (header.codec == kCodecStore) {
+        if (header.storedSize != header.rawSize) return kFrameCorrupt;
+        if (!stored.empty()) std::memcpy(raw.data(), stored.data(), stored.size());
+    }
+    else if (header.codec == kCodecLz4) {
+        if (!Lz4DecompressBlock(stored.data(), stored.size(), raw.data(), raw.size())) return kFrameCorrupt;
+    }
+    else {
+        return kFrameCorrupt;
+    }
+
+    return FrameChecksum(raw.data(), raw.size()) == header.checksum ? kFrameOk : kFrameCorrupt;
+}
+
+// Walks the frames at the start of file that ReadFrame accepts. Returns
+// their total raw size and sets goodBytes to the file offset just past the
+// last of them; a writer appending to a run that was cut off truncates the
+// file there first, so its frames are not stranded behind a torn tail.
+inline uint64_t FrameStreamValidPrefix(std::FILE* file, uint64_t& goodBytes) {
+    FrameHeader header;
+    std::vector<uint8_t> raw;
+    uint64_t total = 0;
+    goodBytes = 0;
+    while (ReadFrame(file, header, raw) == kFrameOk) {
+        total += header.rawSize;
+        goodBytes += kFrameHeaderSize + header.storedSize;
+    }
+    return total;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+// Compile-time profiles for the runtime il2cpp structures the live scan
+// reads. The dumper reads its own process, so the pointer width is the
+// build's; the runtime generation is chosen once at startup. Discovery and
+// class analysis are templated on a profile, so the inner loops see these
+// offsets as constants.
+//
+//   using Layout = Il2CppLayout<sizeof(void*), Il2CppRuntime::V24>;
+//   FastReadPointer(process, classPtr, Layout::kNameOff, &namePtr);
+//
+// Class offsets are the ones observed in this game's x64 build. No 32-bit
+// build has been measured, so there is no 4-byte profile: instantiating one
+// fails to compile, and a Win32 dumper skips the passes that need it.
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Named after the global-metadata version that introduced the runtime layout.
+enum class Il2CppRuntime : int {
+    V24 = 24,  // Unity 2018.3 - 2021.1
+    V29 = 29,  // Unity 2021.2+, MethodInfo gains virtualMethodPointer
+};
+
+inline Il2CppRuntime Il2CppRuntimeForVersion(int metadataVersion) {
+    return metadataVersion >= 29 ? Il2CppRuntime::V29 : Il2CppRuntime::V24;
+}
+
+struct Il2CppFieldInfo {
+    const char* name;
+    void* type;
+    void* parent;
+    int32_t offset;
+    uint32_t token;
+};
+
+struct Il2CppMethodInfoV24 {
+    void* methodPointer;
+    void* invoker_method;
+    const char* name;
+    void* klass;
+    void* return_type;
+    void* parameters;
+    void* rgctx_data;
+    void* generic_container;
+    uint32_t token;
+    uint16_t flags;
+    uint16_t iflags;
+    uint16_t slot;
+    uint8_t parameters_count;
+};
+
+struct Il2CppMethodInfoV29 {
+    void* methodPointer;
+    void* virtualMethodPointer;
+    void* invoker_method;
+    const char* name;
+    void* klass;
+    void* return_type;
+    void* parameters;
+    void* rgctx_data;
+    void* generic_container;
+    uint32_t token;
+    uint16_t flags;
+    uint16_t iflags;
+    uint16_t slot;
+    uint8_t parameters_count;
+};
+
+template <size_t PointerSize>
+struct Il2CppClassLayout;
+
+template <>
+struct Il2CppClassLayout<8> {
+    static constexpr int kNameOff = 0x30;
+    static constexpr int kNsOff = 0x38;
+    static constexpr int kParentOff = 0x58;
+    static constexpr int kGenericClassOff = 0x60;
+    static constexpr int kFieldsOff = 0x80;
+    static constexpr int kMethodsOff = 0x98;
+    static constexpr int kFieldCountOff = 0x9C;
+    static constexpr int kMethodCountOff = 0xFC;
+};
+
+template <size_t PointerSize, Il2CppRuntime Runtime>
+struct Il2CppLayout : Il2CppClassLayout<PointerSize> {
+    static_assert(PointerSize == 8, "il2cpp class offsets are only known for x64 runtimes");
+
+    static constexpr Il2CppRuntime kRuntime = Runtime;
+    static constexpr size_t kPointerSize = PointerSize;
+
+    using FieldInfo = Il2CppFieldInfo;
+    using MethodInfo = std::conditional_t<Runtime == Il2CppRuntime::V29, Il2CppMethodInfoV29, Il2CppMethodInfoV24>;
+
+    // Name and namespace are adjacent, so the word after a name pointer
+    // can be checked as a namespace during join discovery.
+    static constexpr bool kNsFollowsName =
+        Il2CppClassLayout<PointerSize>::kNsOff == Il2CppClassLayout<PointerSize>::kNameOff + static_cast<int>(PointerSize);
+
+    static const char* Name() {
+        return Runtime == Il2CppRuntime::V29 ? "x64 v29" : "x64 v24";
+    }
+};
+
+using Il2CppLayoutV24 = Il2CppLayout<sizeof(void*), Il2CppRuntime::V24>;
+using Il2CppLayoutV29 = Il2CppLayout<sizeof(void*), Il2CppRuntime::V29>;
@@ -7,25 +7,39 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <emmintrin.h>
 #include <fstream>
 #include <iomanip>
 #include <ios>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 #include <sstream>
 #include <unordered_set>
 #include <unordered_map>
 
+#include "dump_index.h"
+#include "format_buffer.h"
+#include "frame_codec.h"
+#include "il2cpp_layout.h"
+#include "metadata_parser.h"
+#include "query_server.h"
+#include "string_score.h"
+
 DWORD WINAPI Run(LPVOID lpParam);
 
 using u8 = uint8_t;
+using u32 = uint32_t;
 using u64 = uint64_t;
 
 struct DumperOptions {
@@ -46,18 +60,37 @@ struct DumperOptions {
     bool enableAllStringDump = false;
     bool enableRelatedStringsOnly = true;
     bool enableImportantStringsOnly = true;
+    bool enableFieldTypes = true;
+    bool enableRuntimeTypeDirectory = false;
+    bool enableCompressedOutput = false;
+    int lz4Level = 1;  // 1 = greedy LZ4; 2-9 walk a 2^level deep hash chain for LZ4 ratio, not zstd-class ratio
+    int compressionWorkers = 1;
+    bool enableDumpIndex = true;
+    int scanCpuBudgetPercent = 100;
+    int scanThreadPriority = THREAD_PRIORITY_NORMAL;
+    int memoryBudgetMB = 1024;
+    bool enableSnapshotCapture = false;
+    int snapshotWorkers = 4;
+    bool enableStringXrefs = false;
+    bool enableHeapCensus = false;
+    std::string metadataPath;
+    int metadataWorkers = 4;
+    int il2cppRuntimeVersion = 0;
+    bool enableQueryServer = false;
+    std::string queryEndpoint = "kazik_query";
+    int queryLingerSeconds = 60;
+    bool enableGenericFolding = true;
+    bool enableStringFilter = true;
+    int stringMinScore = 60;
+    int stringMaxPunctPercent = 30;
+    int stringMaxRepeatPercent = 60;
+    int stringMinEntropyTenths = 15;
+    int stringMaxEntropyTenths = 53;
+    bool enableNameJoinDiscovery = false;
 };
 
 static DumperOptions g_options;
 
-static int kNameOff = 0x30;
-static int kNsOff = 0x38;
-static int kParentOff = 0x58;
-static int kFieldsOff = 0x80;
-static int kMethodsOff = 0x98;
-static int kFieldCountOff = 0x9C;
-static int kMethodCountOff = 0xFC;
-
 static std::mutex g_logMtx;
 static std::FILE* g_log = nullptr;
 static std::atomic<int> g_classCount{ 0 };
@@ -76,10 +109,15 @@ struct Vector3 {
         return abs(x - other.x) > 0.001f || abs(y - other.y) > 0.001f || abs(z - other.z) > 0.001f;
     }
 
+    template <typename Buffer>
+    void FormatTo(Buffer& out) const {
+        out << '(' << Fixed(x, 3) << ", " << Fixed(y, 3) << ", " << Fixed(z, 3) << ')';
+    }
+
     std::string toString() const {
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(3) << "(" << x << ", " << y << ", " << z << ")";
-        return oss.str();
+        LineBuffer text;
+        FormatTo(text);
+        return text.Str();
     }
 };
 
@@ -104,6 +142,7 @@ struct FoundAddress {
     void* address;
     std::string signature;
     bool isImportant = false;
+    int importantSlot = -1;
     std::vector<std::string> relatedStrings;
 };
 
@@ -112,6 +151,12 @@ struct ClassInfo {
     std::string nameSpace;
     std::string fullName;
     void* address;
+    u32 token = 0;
+    std::string genericArgs;
+    int genericOf = 0;
+    std::string genericOfName;
+    size_t genericShared = 0;
+    std::vector<std::string> genericDiffs;
     std::vector<std::string> fields;
     std::vector<std::string> methods;
     std::vector<FoundAddress> foundAddresses;
@@ -132,16 +177,311 @@ struct ConnectionInfo {
     std::vector<std::string> relatedStrings;
 };
 
-static std::vector<ClassInfo> g_allClasses;
-static std::vector<std::string> g_allStrings;
+// Append-only store split into shards. Items are spread by key (usually the
+// address they describe) or round-robin, so a single scan thread still
+// spreads its writes and only contends with a reader walking that one shard.
+template <typename T>
+struct ShardedStore {
+    static constexpr size_t kShardCount = 16;
+
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::vector<T> items;
+    };
+
+    Shard shards[kShardCount];
+    std::atomic<size_t> count{ 0 };
+
+    static size_t ShardIndex(uintptr_t key) {
+        u64 mixed = static_cast<u64>(key) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed >> 60) % kShardCount;
+    }
+
+    void Append(T item) {
+        Insert(shards[count.fetch_add(1) % kShardCount], std::move(item));
+    }
+
+    void Append(T item, uintptr_t key) {
+        count++;
+        Insert(shards[ShardIndex(key)], std::move(item));
+    }
+
+    static void Insert(Shard& shard, T item) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.items.push_back(std::move(item));
+    }
+
+    template <typename Fn>
+    void ForEach(Fn&& fn) {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            for (auto& item : shard.items) {
+                fn(item);
+            }
+        }
+    }
+
+    size_t Size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+};
+
+// Dumper-owned memory regions. Arena blocks are registered here so the
+// region walks skip our own scratch memory instead of scanning it.
+static std::mutex g_dumperRegionMutex;
+static std::set<const void*> g_dumperRegions;
+
+static bool IsDumperRegion(const void* allocationBase) {
+    std::lock_guard<std::mutex> lock(g_dumperRegionMutex);
+    return g_dumperRegions.count(allocationBase) != 0;
+}
+
+static std::atomic<u64> g_arenaBytes{ 0 };
+static std::atomic<u64> g_arenaPeakBytes{ 0 };
+static std::atomic<u64> g_retainedBytes{ 0 };
+
+// Bump allocator over VirtualAlloc'd blocks, so phase scratch never touches
+// the host heap we are scanning. Scopes record a mark and rewind to it, which
+// frees everything allocated inside the scope at once. Blocks are kept for
+// reuse by the next scope.
+struct ScanArena {
+    static constexpr size_t kBlockSize = 1024 * 1024;
+
+    struct Block {
+        u8* base;
+        size_t size;
+        size_t used;
+    };
+
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+
+    ScanArena() = default;
+    ScanArena(const ScanArena&) = delete;
+    ScanArena& operator=(const ScanArena&) = delete;
+
+    ~ScanArena() {
+        for (const auto& block : blocks) {
+            ReleaseBlock(block);
+        }
+    }
+
+    void* Allocate(size_t size, size_t align) {
+        for (;;) {
+            if (current < blocks.size()) {
+                Block& block = blocks[current];
+                size_t start = (block.used + align - 1) & ~(align - 1);
+                if (start + size <= block.size) {
+                    block.used = start + size;
+                    return block.base + start;
+                }
+                if (current + 1 < blocks.size()) {
+                    current++;
+                    blocks[current].used = 0;
+                    continue;
+                }
+            }
+
+            size_t blockSize = (std::max)(kBlockSize, (size + align + 0xFFFF) & ~static_cast<size_t>(0xFFFF));
+            u8* base = static_cast<u8*>(VirtualAlloc(nullptr, blockSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+            if (!base) throw std::bad_alloc();
+
+            {
+                std::lock_guard<std::mutex> lock(g_dumperRegionMutex);
+                g_dumperRegions.insert(base);
+            }
+            u64 total = g_arenaBytes += blockSize;
+            u64 peak = g_arenaPeakBytes.load();
+            while (total > peak && !g_arenaPeakBytes.compare_exchange_weak(peak, total)) {
+            }
+
+            blocks.push_back({ base, blockSize, 0 });
+            current = blocks.size() - 1;
+        }
+    }
+
+    Mark GetMark() const {
+        return { current, current < blocks.size() ? blocks[current].used : 0 };
+    }
+
+    void Rewind(const Mark& mark) {
+        current = mark.block;
+        if (current < blocks.size()) blocks[current].used = mark.used;
+
+        // Oversized blocks from a large scope are not worth keeping.
+        while (blocks.size() > current + 1 && blocks.back().size > kBlockSize) {
+            ReleaseBlock(blocks.back());
+            blocks.pop_back();
+        }
+    }
+
+    static void ReleaseBlock(const Block& block) {
+        {
+            std::lock_guard<std::mutex> lock(g_dumperRegionMutex);
+            g_dumperRegions.erase(block.base);
+        }
+        g_arenaBytes -= block.size;
+        VirtualFree(block.base, 0, MEM_RELEASE);
+    }
+};
+
+// Per-thread arena for phase scratch (regions, chunks, classes).
+static ScanArena& PhaseArena() {
+    static thread_local ScanArena arena;
+    return arena;
+}
+
+struct ArenaScope {
+    ScanArena& arena;
+    ScanArena::Mark mark;
+
+    explicit ArenaScope(ScanArena& a) : arena(a), mark(a.GetMark()) {}
+    ~ArenaScope() { arena.Rewind(mark); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ScanArena* arena;
+
+    explicit ArenaAllocator(ScanArena& a) noexcept : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Append-only arena storage in fixed-size chunks. An ArenaVector that grows
+// strands every old buffer in the bump arena; chunks are never moved, so
+// only the small chunk table does. Random-access iterators allow sorting in
+// place.
+template <typename T>
+struct ArenaChunkedVector {
+    static constexpr size_t kChunkShift = 14;
+    static constexpr size_t kChunkSize = size_t(1) << kChunkShift;
+
+    ArenaVector<T*> chunks;
+    size_t count = 0;
+
+    explicit ArenaChunkedVector(ScanArena& arena) : chunks(ArenaAllocator<T*>(arena)) {}
+
+    void push_back(const T& value) {
+        size_t chunk = count >> kChunkShift;
+        if (chunk == chunks.size()) {
+            chunks.push_back(static_cast<T*>(chunks.get_allocator().arena->Allocate(kChunkSize * sizeof(T), alignof(T))));
+        }
+        chunks[chunk][count & (kChunkSize - 1)] = value;
+        count++;
+    }
+
+    T& operator[](size_t index) { return chunks[index >> kChunkShift][index & (kChunkSize - 1)]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Drops the tail; chunks stay allocated for reuse.
+    void Truncate(size_t newSize) { count = (std::min)(count, newSize); }
+
+    struct iterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        ArenaChunkedVector* owner;
+        ptrdiff_t index;
+
+        reference operator*() const { return (*owner)[static_cast<size_t>(index)]; }
+        pointer operator->() const { return &**this; }
+        reference operator[](difference_type n) const { return (*owner)[static_cast<size_t>(index + n)]; }
+        iterator& operator++() { ++index; return *this; }
+        iterator operator++(int) { iterator old = *this; ++index; return old; }
+        iterator& operator--() { --index; return *this; }
+        iterator operator--(int) { iterator old = *this; --index; return old; }
+        iterator& operator+=(difference_type n) { index += n; return *this; }
+        iterator& operator-=(difference_type n) { index -= n; return *this; }
+        iterator operator+(difference_type n) const { return { owner, index + n }; }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+        iterator operator-(difference_type n) const { return { owner, index - n }; }
+        difference_type operator-(const iterator& other) const { return index - other.index; }
+        bool operator==(const iterator& other) const { return index == other.index; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+        bool operator<(const iterator& other) const { return index < other.index; }
+        bool operator>(const iterator& other) const { return index > other.index; }
+        bool operator<=(const iterator& other) const { return index <= other.index; }
+        bool operator>=(const iterator& other) const { return index >= other.index; }
+    };
+
+    iterator begin() { return { this, 0 }; }
+    iterator end() { return { this, static_cast<ptrdiff_t>(count) }; }
+};
+
+template <typename String>
+static void AppendHex(String& out, uintptr_t value) {
+    char buffer[2 * sizeof(uintptr_t)];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, 16);
+    out.append(buffer, result.ptr);
+}
+
+template <typename String>
+static void AppendDec(String& out, long long value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Published copy of the first important addresses for the console. Writers
+// rebuild it under g_importantMutex; readers just atomically load the pointer.
+struct ImportantEntry {
+    std::string type;
+    std::string name;
+    std::string className;
+    void* address;
+    size_t relatedCount;
+};
+
+static constexpr size_t kImportantDisplayCount = 10;
+
+static ShardedStore<ClassInfo> g_allClasses;
+static ShardedStore<std::string> g_allStrings;
 static std::vector<ConnectionInfo> g_allConnections;
-static std::vector<FoundAddress> g_allFoundAddresses;
-static std::vector<TrackedVector> g_allTrackedVectors;
+static ShardedStore<FoundAddress> g_allFoundAddresses;
+static ShardedStore<TrackedVector> g_allTrackedVectors;
 static std::unordered_map<std::string, ClassInfo> g_targetClasses;
 static std::unordered_map<std::string, std::vector<std::string>> g_stringToClassMap;
 static std::mutex g_dataMutex;
 
+static std::mutex g_importantMutex;
+static std::vector<ImportantEntry> g_importantEntries;
+static std::shared_ptr<const std::vector<ImportantEntry>> g_importantSnapshot;
+// Every published snapshot a reader may still hold, for the census.
+static std::vector<std::weak_ptr<const std::vector<ImportantEntry>>> g_importantSnapshots;
+
 static bool g_liveMonitoring = false;
+static QueryServer g_queryServer;
+static std::atomic<bool> g_dumpComplete{ false };
 static HANDLE g_consoleHandle = nullptr;
 
 static std::vector<std::string> g_targetClassNames = {
@@ -192,16 +532,372 @@ static void LogLine(const char* format, ...) {
     OutputDebugStringA((std::string("[GI Dumper] ") + buffer + "\n").c_str());
 }
 
-static void WriteFileImmediately(const std::string& filename, const std::string& content) {
-    if (!g_options.enableRealTimeOutput) return;
+static u64 DumperMemoryBytes() {
+    return g_arenaBytes.load() + g_retainedBytes.load();
+}
+
+// True once the dumper's own footprint passes memoryBudgetMB; retention of
+// bulk data (all strings, related-string lists) stops from then on.
+static bool MemoryBudgetExceeded() {
+    if (g_options.memoryBudgetMB <= 0) return false;
+    static std::atomic<bool> reported{ false };
+    bool exceeded = DumperMemoryBytes() > static_cast<u64>(g_options.memoryBudgetMB) * 1024 * 1024;
+    if (exceeded && !reported.exchange(true)) {
+        LogLine("[MEMORY] Budget of %d MB reached, no longer retaining bulk string data", g_options.memoryBudgetMB);
+    }
+    return exceeded;
+}
+
+// Large sinks that are written as KZF frames when compressed output is on.
+static const std::vector<std::string> g_compressedSinkNames = {
+    "Kitay_Kazik_total_dump.txt", "Kitay_Kazik_all_strings.txt"
+};
+
+static constexpr size_t kSinkFrameSize = 256 * 1024;
+static constexpr size_t kPipelineMaxInFlight = 64;
+
+// Fixed frame buffers carved from one arena allocation. The arena's blocks
+// are dumper regions, so a pooled capture neither grows the host heap nor
+// copies its own buffers into the snapshot.
+struct FrameSlotPool {
+    u8* base = nullptr;
+    size_t slotSize = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<u8*> free;
+
+    void Init(ScanArena& arena, size_t size, size_t count) {
+        slotSize = size;
+        base = static_cast<u8*>(arena.Allocate(size * count, 64));
+        free.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            free.push_back(base + i * size);
+        }
+    }
+
+    u8* Acquire() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return !free.empty(); });
+        u8* slot = free.back();
+        free.pop_back();
+        return slot;
+    }
+
+    void Release(u8* slot) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            free.push_back(slot);
+        }
+        cv.notify_one();
+    }
+};
+
+// Owned bytes, or size bytes in a pool slot.
+struct PendingFrame {
+    u64 sequence = 0;
+    std::vector<u8> raw;
+    u8* slot = nullptr;
+    size_t size = 0;
+};
+
+// GetThreadTimes only advances on the ~15.6 ms clock tick, coarser than a
+// slice; the thread's cycle count is exact but not in time units.
+static u64 ThreadCycles() {
+    ULONG64 cycles = 0;
+    QueryThreadCycleTime(GetCurrentThread(), &cycles);
+    return cycles;
+}
+
+// Helper threads (frame compression, metadata decode) run at the scan
+// thread's priority and add the cycles they use here, so the scan governor
+// budgets them together with the scan thread.
+static std::atomic<u64> g_workerCycles{ 0 };
+
+static u64 WorkerThreadBegin() {
+    SetThreadPriority(GetCurrentThread(), g_options.scanThreadPriority);
+    return ThreadCycles();
+}
+
+static void WorkerChargeCycles(u64& lastCycles) {
+    u64 now = ThreadCycles();
+    g_workerCycles += now - lastCycles;
+    lastCycles = now;
+}
+
+// Frames are compressed on worker threads into a per-worker output buffer
+// and written strictly in submission order: a finished worker waits for its
+// sequence number's turn. With a pool, input frames and the worker buffers
+// are all pool slots.
+struct FramePipeline {
+    std::FILE* file = nullptr;
+    uint8_t codec = kCodecLz4;
+    int level = 1;
+    FrameSlotPool* pool = nullptr;
+    std::mutex mtx;
+    std::condition_variable workCv;
+    std::condition_variable spaceCv;
+    std::condition_variable writeCv;
+    std::deque<PendingFrame> pending;
+    u64 nextSequence = 0;
+    u64 nextWrite = 0;
+    size_t inFlight = 0;
+    bool closing = false;
+    std::vector<std::thread> workers;
+    std::atomic<u64> rawBytes{ 0 };
+    std::atomic<u64> storedBytes{ 0 };
+};
+
+struct CompressedSink {
+    std::mutex mtx;
+    std::vector<u8> buffer;
+    u64 rawOffset = 0;
+    FramePipeline pipeline;
+};
+
+static std::mutex g_sinkMutex;
+static std::unordered_map<std::string, std::unique_ptr<CompressedSink>> g_compressedSinks;
+static std::atomic<u64> g_compressedRawBytes{ 0 };
+static std::atomic<u64> g_compressedStoredBytes{ 0 };
+
+static void FramePipelineWorker(FramePipeline* pipeline, u8* out) {
+    std::vector<u8> scratch;
+    u64 cycles = WorkerThreadBegin();
+
+    for (;;) {
+        PendingFrame item;
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mtx);
+            pipeline->workCv.wait(lock, [&] { return !pipeline->pending.empty() || pipeline->closing; });
+            if (pipeline->pending.empty()) break;
+            item = std::move(pipeline->pending.front());
+            pipeline->pending.pop_front();
+        }
+
+        const u8* raw = item.slot ? item.slot : item.raw.data();
+        size_t rawSize = item.slot ? item.size : item.raw.size();
+        u8* target = out;
+        if (!target) {
+            if (scratch.size() < FrameEncodedBound(rawSize)) scratch.resize(FrameEncodedBound(rawSize));
+            target = scratch.data();
+        }
+        size_t frameSize = EncodeFrameTo(raw, rawSize, pipeline->codec, pipeline->level, target);
+        if (item.slot) pipeline->pool->Release(item.slot);
+        WorkerChargeCycles(cycles);
+
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mtx);
+            pipeline->writeCv.wait(lock, [&] { return pipeline->nextWrite == item.sequence; });
+        }
+
+        std::fwrite(target, 1, frameSize, pipeline->file);
+        std::fflush(pipeline->file);
+        pipeline->storedBytes += frameSize;
+
+        {
+            std::lock_guard<std::mutex> lock(pipeline->mtx);
+            pipeline->nextWrite++;
+            pipeline->inFlight--;
+        }
+        pipeline->writeCv.notify_all();
+        pipeline->spaceCv.notify_all();
+    }
+
+    if (out) pipeline->pool->Release(out);
+}
+
+// Worker output slots are taken here, before the caller can fill the pool
+// with input frames.
+static bool FramePipelineOpen(FramePipeline& pipeline, const std::string& path, int workerCount) {
+    if (fopen_s(&pipeline.file, path.c_str(), "ab") != 0 || !pipeline.file) {
+        pipeline.file = nullptr;
+        return false;
+    }
+
+    for (int i = 0; i < (std::max)(1, workerCount); i++) {
+        u8* out = pipeline.pool ? pipeline.pool->Acquire() : nullptr;
+        pipeline.workers.emplace_back(FramePipelineWorker, &pipeline, out);
+    }
+    return true;
+}
+
+static void FramePipelineEnqueue(FramePipeline& pipeline, PendingFrame&& frame, size_t size) {
+    {
+        std::unique_lock<std::mutex> lock(pipeline.mtx);
+        pipeline.spaceCv.wait(lock, [&] { return pipeline.inFlight < kPipelineMaxInFlight; });
+        pipeline.rawBytes += size;
+        frame.sequence = pipeline.nextSequence++;
+        pipeline.pending.push_back(std::move(frame));
+        pipeline.inFlight++;
+    }
+    pipeline.workCv.notify_one();
+}
+
+static void FramePipelineSubmit(FramePipeline& pipeline, std::vector<u8>&& raw) {
+    if (raw.empty()) return;
+    size_t size = raw.size();
+    PendingFrame frame;
+    frame.raw = std::move(raw);
+    FramePipelineEnqueue(pipeline, std::move(frame), size);
+}
+
+// Hands a pool slot holding size bytes to the pipeline, which releases it.
+static void FramePipelineSubmitSlot(FramePipeline& pipeline, u8* slot, size_t size) {
+    PendingFrame frame;
+    frame.slot = slot;
+    frame.size = size;
+    FramePipelineEnqueue(pipeline, std::move(frame), size);
+}
+
+static void FramePipelineClose(FramePipeline& pipeline) {
+    {
+        std::lock_guard<std::mutex> lock(pipeline.mtx);
+        pipeline.closing = true;
+    }
+    pipeline.workCv.notify_all();
+
+    for (auto& worker : pipeline.workers) {
+        worker.join();
+    }
+    pipeline.workers.clear();
+
+    if (pipeline.file) {
+        std::fclose(pipeline.file);
+        pipeline.file = nullptr;
+    }
+}
+
+// Cuts path down to size bytes if it is longer. Returns false only when the
+// file could not be opened or shortened.
+static bool TruncateFileTo(const std::string& path, u64 size) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    bool ok = true;
+    LARGE_INTEGER current;
+    if (GetFileSizeEx(file, &current) && static_cast<u64>(current.QuadPart) > size) {
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(size);
+        ok = SetFilePointerEx(file, offset, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+        LogLine("[OUTPUT] %s: dropped %llu bytes of torn frames from an interrupted run", path.c_str(),
+            static_cast<unsigned long long>(current.QuadPart) - static_cast<unsigned long long>(size));
+    }
+    CloseHandle(file);
+    return ok;
+}
+
+static CompressedSink* GetCompressedSink(std::string_view filename) {
+    if (!g_options.enableCompressedOutput) return nullptr;
+    auto name = std::find(g_compressedSinkNames.begin(), g_compressedSinkNames.end(), filename);
+    if (name == g_compressedSinkNames.end()) return nullptr;
+    const std::string& sinkName = *name;
+
+    std::lock_guard<std::mutex> lock(g_sinkMutex);
+    auto& sink = g_compressedSinks[sinkName];
+    if (!sink) {
+        std::string path = TempPath((sinkName + ".kzf").c_str());
+        sink = std::make_unique<CompressedSink>();
+        sink->pipeline.level = g_options.lz4Level;
+
+        // A previous run's frames stay; anything after its last good frame
+        // is cut off so this run's frames remain reachable.
+        std::FILE* existing = nullptr;
+        bool usable = true;
+        if (fopen_s(&existing, path.c_str(), "rb") == 0 && existing) {
+            u64 goodBytes = 0;
+            sink->rawOffset = FrameStreamValidPrefix(existing, goodBytes);
+            std::fclose(existing);
+            usable = TruncateFileTo(path, goodBytes);
+        }
+
+        if (!usable || !FramePipelineOpen(sink->pipeline, path, g_options.compressionWorkers)) {
+            sink.reset();
+        }
+    }
+    return sink.get();
+}
+
+static u64 AppendToCompressedSink(CompressedSink& sink, std::string_view content) {
+    std::lock_guard<std::mutex> lock(sink.mtx);
+    u64 offset = sink.rawOffset;
+    sink.buffer.insert(sink.buffer.end(), content.begin(), content.end());
+    sink.buffer.push_back('\n');
+    sink.rawOffset += content.size() + 1;
+
+    if (sink.buffer.size() >= kSinkFrameSize) {
+        std::vector<u8> frame;
+        frame.reserve(kSinkFrameSize + 4096);
+        frame.swap(sink.buffer);
+        FramePipelineSubmit(sink.pipeline, std::move(frame));
+    }
+    return offset;
+}
+
+static void CloseCompressedSinks() {
+    std::lock_guard<std::mutex> lock(g_sinkMutex);
+    for (auto& entry : g_compressedSinks) {
+        CompressedSink& sink = *entry.second;
+        {
+            std::lock_guard<std::mutex> sinkLock(sink.mtx);
+            FramePipelineSubmit(sink.pipeline, std::move(sink.buffer));
+            sink.buffer.clear();
+        }
+        FramePipelineClose(sink.pipeline);
+
+        g_compressedRawBytes += sink.pipeline.rawBytes.load();
+        g_compressedStoredBytes += sink.pipeline.storedBytes.load();
+    }
+    g_compressedSinks.clear();
+}
 
-    std::string fullPath = TempPath(filename.c_str());
+// Appends content as one line and returns the uncompressed offset it was
+// written at, or kDumpIndexNoOffset if nothing was written.
+static u64 WriteFileImmediately(std::string_view filename, std::string_view content) {
+    if (!g_options.enableRealTimeOutput) return kDumpIndexNoOffset;
+
+    if (CompressedSink* sink = GetCompressedSink(filename)) {
+        return AppendToCompressedSink(*sink, content);
+    }
+
+    u64 offset = kDumpIndexNoOffset;
+    std::string fullPath = TempPath(std::string(filename).c_str());
     std::ofstream file(fullPath, std::ios::app);
     if (file.is_open()) {
+        file.seekp(0, std::ios::end);
+        offset = static_cast<u64>(file.tellp());
         file << content << std::endl;
         file.flush();
         file.close();
     }
+    return offset;
+}
+
+static ShardedStore<DumpIndexRecord> g_indexRecords;
+
+// The dump file whose class blocks the index points into.
+static std::string IndexedDumpName() {
+    std::string name = !g_options.enableFileGrouping ? "Kitay_Kazik_complete_analysis.txt" :
+        g_options.enableTotalDump ? "Kitay_Kazik_total_dump.txt" : "Kitay_Kazik_important_dump.txt";
+    if (g_options.enableCompressedOutput &&
+        std::find(g_compressedSinkNames.begin(), g_compressedSinkNames.end(), name) != g_compressedSinkNames.end()) {
+        name += ".kzf";
+    }
+    return name;
+}
+
+static void WriteIndexFile() {
+    std::vector<DumpIndexRecord> records;
+    records.reserve(g_indexRecords.Size());
+    g_indexRecords.ForEach([&](const DumpIndexRecord& record) {
+        records.push_back(record);
+    });
+
+    std::string path = TempPath("Kitay_Kazik_dump_index.kzi");
+    if (WriteDumpIndex(path, IndexedDumpName(), records)) {
+        LogLine("[INDEX] Wrote %zu entries to %s", records.size(), path.c_str());
+    }
+    else {
+        LogLine("[INDEX] Failed to write %s", path.c_str());
+    }
 }
 
 static void DisplayCurrentOptions() {
@@ -213,12 +909,31 @@ static void DisplayCurrentOptions() {
     LogLine("Real-time Output: %s", g_options.enableRealTimeOutput ? "ON" : "OFF");
     LogLine("Comprehensive Dump: %s", g_options.enableComprehensiveDump ? "ON" : "OFF");
     LogLine("Address Discovery: %s", g_options.enableAddressDiscovery ? "ON" : "OFF");
+    LogLine("Connection Analysis: %s", g_options.enableConnectionAnalysis ? "ON" : "OFF");
     LogLine("Console Monitoring: %s", g_options.enableConsoleMonitoring ? "ON" : "OFF");
     LogLine("Position Vector Tracking: %s", g_options.enablePositionVectorTracking ? "ON" : "OFF");
     LogLine("Damage Vector Tracking: %s", g_options.enableDamageVectorTracking ? "ON" : "OFF");
     LogLine("All String Dump: %s", g_options.enableAllStringDump ? "ON" : "OFF");
     LogLine("Related Strings Only: %s", g_options.enableRelatedStringsOnly ? "ON" : "OFF");
     LogLine("Important Strings Only: %s", g_options.enableImportantStringsOnly ? "ON" : "OFF");
+    LogLine("Field Types: %s", g_options.enableFieldTypes ? "ON" : "OFF");
+    LogLine("Runtime Type Directory: %s", g_options.enableRuntimeTypeDirectory ? "ON" : "OFF");
+    LogLine("Dump Index: %s", g_options.enableDumpIndex ? "ON" : "OFF");
+    LogLine("Scan CPU Budget: %d%% (priority %d)", g_options.scanCpuBudgetPercent, g_options.scanThreadPriority);
+    LogLine("Memory Budget: %d MB", g_options.memoryBudgetMB);
+    LogLine("Compressed Output: %s (LZ4 level %d)", g_options.enableCompressedOutput ? "ON" : "OFF",
+        g_options.lz4Level);
+    LogLine("String Xrefs: %s", g_options.enableStringXrefs ? "ON" : "OFF");
+    LogLine("Heap Census: %s", g_options.enableHeapCensus ? "ON" : "OFF");
+    LogLine("Metadata File: %s", g_options.metadataPath.empty() ? "OFF (heap discovery)" : g_options.metadataPath.c_str());
+    LogLine("IL2CPP Runtime: %s", g_options.il2cppRuntimeVersion ?
+        std::to_string(g_options.il2cppRuntimeVersion).c_str() : "auto");
+    LogLine("Snapshot Capture: %s (%d workers)", g_options.enableSnapshotCapture ? "ON" : "OFF",
+        g_options.snapshotWorkers);
+    LogLine("String Filter: %s (min score %d)", g_options.enableStringFilter ? "ON" : "OFF", g_options.stringMinScore);
+    LogLine("Name Join Discovery: %s", g_options.enableNameJoinDiscovery ? "ON" : "OFF");
+    LogLine("Generic Folding: %s", g_options.enableGenericFolding ? "ON" : "OFF");
+    LogLine("Query Server: %s (%s)", g_options.enableQueryServer ? "ON" : "OFF", g_options.queryEndpoint.c_str());
     LogLine("======================");
 }
 
@@ -236,7 +951,8 @@ static bool FastReadPointer(HANDLE process, const void* base, int offset, void**
     return FastReadMemory(process, ptrAddr, result, sizeof(void*));
 }
 
-static bool FastReadString(HANDLE process, const void* strAddr, std::string& result, size_t maxLen = 200) {
+template <typename String>
+static bool FastReadString(HANDLE process, const void* strAddr, String& result, size_t maxLen = 200) {
     if (!strAddr) return false;
 
     char buffer[256];
@@ -326,22 +1042,23 @@ static void UpdateConsoleDisplay() {
 
     if (g_options.enableVectorTracking) {
         std::cout << "Vector Changes: " << g_vectorChangeCount.load()
-            << " | Tracked Vectors: " << g_allTrackedVectors.size() << std::endl;
+            << " | Tracked Vectors: " << g_allTrackedVectors.Size() << std::endl;
     }
 
     std::cout << "================================================================" << std::endl;
 
     if (g_options.enableAddressDiscovery && g_options.enableImportantDump) {
         std::cout << "DISCOVERED ADDRESSES (IMPOTENT):" << std::endl;
-        std::lock_guard<std::mutex> lock(g_dataMutex);
-        int count = 0;
-        for (const auto& addr : g_allFoundAddresses) {
-            if (count < 10 && addr.isImportant) {
-                std::cout << "[" << (count + 1) << "] " << addr.type << ": " << addr.name
-                    << " @ 0x" << std::hex << addr.address << std::endl;
+        auto snapshot = std::atomic_load(&g_importantSnapshot);
+        if (snapshot) {
+            int count = 0;
+            for (const auto& addr : *snapshot) {
+                LineBuffer line;
+                line << '[' << (count + 1) << "] " << addr.type << ": " << addr.name << " @ " << Hex(addr.address);
+                std::cout << line.View() << std::endl;
                 std::cout << "    Class: " << addr.className;
-                if (g_options.enableStringRelation && !addr.relatedStrings.empty()) {
-                    std::cout << " | Related Strings: " << addr.relatedStrings.size();
+                if (g_options.enableStringRelation && addr.relatedCount > 0) {
+                    std::cout << " | Related Strings: " << addr.relatedCount;
                 }
                 std::cout << std::endl;
                 count++;
@@ -351,153 +1068,711 @@ static void UpdateConsoleDisplay() {
 
     if (g_options.enableVectorTracking) {
         std::cout << std::endl << "VIKTORINA TRACKING:" << std::endl;
-        std::lock_guard<std::mutex> lock(g_dataMutex);
         int vectorCount = 0;
-        for (const auto& vec : g_allTrackedVectors) {
+        g_allTrackedVectors.ForEach([&](const TrackedVector& vec) {
             if (vectorCount < 5 && vec.changeCount > 0) {
-                std::cout << "[" << (vectorCount + 1) << "] " << vec.className << "::" << vec.name
-                    << " @ 0x" << std::hex << vec.address << std::endl;
-                std::cout << "    Current: " << vec.currentValue.toString()
-                    << " | Changes: " << vec.changeCount << std::endl;
+                LineBuffer line;
+                line << '[' << (vectorCount + 1) << "] " << vec.className << "::" << vec.name
+                    << " @ " << Hex(vec.address) << "\n    Current: ";
+                vec.currentValue.FormatTo(line);
+                line << " | Changes: " << vec.changeCount;
+                std::cout << line.View() << std::endl;
                 vectorCount++;
             }
-        }
+        });
     }
 
     std::cout << "\nFiles written to: " << TempPath("") << std::endl;
 }
 
-static void AnalyzeStringRelations(const std::string& str, void* stringAddr,
-    const std::string& className = "", const std::string& methodName = "") {
-    if (!g_options.enableStringRelation) return;
+// Called with g_importantMutex held.
+static void PublishImportantSnapshot() {
+    auto snapshot = std::make_shared<const std::vector<ImportantEntry>>(g_importantEntries);
+    g_importantSnapshots.erase(std::remove_if(g_importantSnapshots.begin(), g_importantSnapshots.end(),
+        [](const auto& held) { return held.expired(); }), g_importantSnapshots.end());
+    g_importantSnapshots.push_back(snapshot);
+    std::atomic_store(&g_importantSnapshot, std::move(snapshot));
+}
 
-    std::lock_guard<std::mutex> lock(g_dataMutex);
+static void AnalyzeStringRelations(std::string_view str, void* stringAddr,
+    const std::string& className = "", const std::string& methodName = "") {
+    if (!g_options.enableStringRelation || MemoryBudgetExceeded()) return;
 
     if (!className.empty()) {
-        g_stringToClassMap[str].push_back(className);
+        std::lock_guard<std::mutex> lock(g_dataMutex);
+        g_stringToClassMap[std::string(str)].push_back(className);
     }
 
-    for (auto& addr : g_allFoundAddresses) {
-        if (str.find(addr.name) != std::string::npos ||
-            addr.name.find(str) != std::string::npos ||
-            str.find(addr.className) != std::string::npos) {
-            addr.relatedStrings.push_back(str + " @ 0x" +
+    std::vector<std::pair<int, size_t>> importantUpdates;
+
+    g_allFoundAddresses.ForEach([&](FoundAddress& addr) {
+        if (str.find(addr.name) != std::string_view::npos ||
+            addr.name.find(str) != std::string_view::npos ||
+            str.find(addr.className) != std::string_view::npos) {
+            addr.relatedStrings.push_back(std::string(str) + " @ 0x" +
                 std::to_string(reinterpret_cast<uintptr_t>(stringAddr)));
+            g_retainedBytes += str.size() + 24;
+            if (addr.importantSlot >= 0) {
+                importantUpdates.emplace_back(addr.importantSlot, addr.relatedStrings.size());
+            }
         }
-    }
+    });
 
-    for (auto& classInfo : g_allClasses) {
-        if (str.find(classInfo.name) != std::string::npos ||
-            str.find(classInfo.fullName) != std::string::npos) {
-            classInfo.relatedStrings.push_back(str + " @ 0x" +
+    g_allClasses.ForEach([&](ClassInfo& classInfo) {
+        if (str.find(classInfo.name) != std::string_view::npos ||
+            str.find(classInfo.fullName) != std::string_view::npos) {
+            classInfo.relatedStrings.push_back(std::string(str) + " @ 0x" +
                 std::to_string(reinterpret_cast<uintptr_t>(stringAddr)));
+            g_retainedBytes += str.size() + 24;
+        }
+    });
+
+    if (!importantUpdates.empty()) {
+        std::lock_guard<std::mutex> lock(g_importantMutex);
+        for (const auto& update : importantUpdates) {
+            g_importantEntries[update.first].relatedCount = update.second;
         }
+        PublishImportantSnapshot();
     }
 }
 
-struct Il2CppFieldInfo {
-    const char* name;
+struct Il2CppType {
+    void* data;
+    uint32_t bits;
+};
+
+struct Il2CppArrayType {
+    void* etype;
+    uint8_t rank;
+};
+
+struct Il2CppGenericClass {
     void* type;
-    void* parent;
-    int32_t offset;
-    uint32_t token;
+    void* classInst;
+    void* methodInst;
+    void* cachedClass;
 };
 
-struct Il2CppMethodInfo {
-    void* methodPointer;
-    void* invoker_method;
-    const char* name;
-    void* klass;
-    void* return_type;
-    void* parameters;
-    void* rgctx_data;
-    void* generic_container;
-    uint32_t token;
-    uint16_t flags;
-    uint16_t iflags;
-    uint16_t slot;
-    uint8_t parameters_count;
+struct Il2CppGenericInst {
+    uint32_t typeArgc;
+    void** typeArgv;
 };
 
-static bool IsImportantMethod(const std::string& methodName) {
-    for (const auto& targetMethod : g_targetMethodNames) {
-        if (methodName.find(targetMethod) != std::string::npos) {
-            return true;
-        }
-    }
-    return false;
-}
+enum Il2CppTypeEnum : uint8_t {
+    IL2CPP_TYPE_VOID = 0x01,
+    IL2CPP_TYPE_BOOLEAN = 0x02,
+    IL2CPP_TYPE_CHAR = 0x03,
+    IL2CPP_TYPE_I1 = 0x04,
+    IL2CPP_TYPE_U1 = 0x05,
+    IL2CPP_TYPE_I2 = 0x06,
+    IL2CPP_TYPE_U2 = 0x07,
+    IL2CPP_TYPE_I4 = 0x08,
+    IL2CPP_TYPE_U4 = 0x09,
+    IL2CPP_TYPE_I8 = 0x0a,
+    IL2CPP_TYPE_U8 = 0x0b,
+    IL2CPP_TYPE_R4 = 0x0c,
+    IL2CPP_TYPE_R8 = 0x0d,
+    IL2CPP_TYPE_STRING = 0x0e,
+    IL2CPP_TYPE_PTR = 0x0f,
+    IL2CPP_TYPE_BYREF = 0x10,
+    IL2CPP_TYPE_VALUETYPE = 0x11,
+    IL2CPP_TYPE_CLASS = 0x12,
+    IL2CPP_TYPE_VAR = 0x13,
+    IL2CPP_TYPE_ARRAY = 0x14,
+    IL2CPP_TYPE_GENERICINST = 0x15,
+    IL2CPP_TYPE_TYPEDBYREF = 0x16,
+    IL2CPP_TYPE_I = 0x18,
+    IL2CPP_TYPE_U = 0x19,
+    IL2CPP_TYPE_FNPTR = 0x1b,
+    IL2CPP_TYPE_OBJECT = 0x1c,
+    IL2CPP_TYPE_SZARRAY = 0x1d,
+    IL2CPP_TYPE_MVAR = 0x1e,
+};
 
-static void RecordFoundAddress(const std::string& name, const std::string& className,
-    const std::string& type, void* address, const std::string& signature) {
-    if (!g_options.enableAddressDiscovery) return;
+// Decoded type names keyed by Il2CppType*. Thousands of fields share a few
+// dozen types, so each distinct pointer is decoded once per run.
+struct TypeNameCache {
+    static constexpr size_t kShardCount = 16;
 
-    FoundAddress foundAddr;
-    foundAddr.name = name;
-    foundAddr.className = className;
-    foundAddr.type = type;
-    foundAddr.address = address;
-    foundAddr.signature = signature;
-    foundAddr.isImportant = IsImportantMethod(name) ||
-        std::find(g_targetClassNames.begin(), g_targetClassNames.end(), className) != g_targetClassNames.end();
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::unordered_map<void*, std::string> names;
+    };
 
-    {
-        std::lock_guard<std::mutex> lock(g_dataMutex);
-        g_allFoundAddresses.push_back(foundAddr);
-        g_addressCount++;
+    Shard shards[kShardCount];
+    std::atomic<u64> hits{ 0 };
+    std::atomic<u64> misses{ 0 };
+
+    Shard& ShardFor(void* key) {
+        return shards[(reinterpret_cast<uintptr_t>(key) >> 4) % kShardCount];
     }
 
-    if (foundAddr.isImportant) {
-        LogLine("[DOKS ADDRESS FOUND] %s::%s @ 0x%p (%s)", className.c_str(), name.c_str(), address, type.c_str());
+    bool Find(void* key, std::string& out) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.names.find(key);
+        if (it == shard.names.end()) return false;
+        out = it->second;
+        return true;
+    }
 
-        if (g_options.enableFileGrouping) {
-            std::ostringstream addrOutput;
-            addrOutput << "[" << type << "] " << className << "::" << name
-                << " @ 0x" << std::hex << address << std::endl;
-            addrOutput << "  Signature: " << signature << std::endl;
-            WriteFileImmediately("Kitay_Kazik_addresses_" + type + ".txt", addrOutput.str());
+    void Insert(void* key, const std::string& name) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.names.emplace(key, name);
+    }
+
+    size_t Size() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            total += shard.names.size();
         }
-        else {
-            std::ostringstream addrOutput;
-            addrOutput << "[" << type << "] " << className << "::" << name
-                << " @ 0x" << std::hex << address << std::endl;
-            WriteFileImmediately("Kitay_Kazik_current_addresses.txt", addrOutput.str());
+        return total;
+    }
+};
+
+static TypeNameCache g_typeNameCache;
+
+// A CLASS or VALUETYPE Il2CppType carries a type definition index (v24) or
+// a metadata handle (v27+) rather than an Il2CppClass*, so it cannot be
+// followed in memory, and prints as class#index / class@handle. With
+// enableRuntimeTypeDirectory the runtime's exported API enumerates every
+// class with its byval type, and the directory maps that type's data word
+// to the class name once, before discovery. That walk initialises every
+// class the game has not loaded yet and allocates on its heap, so it is off
+// by default; read-only discovery never calls into the runtime.
+struct Il2CppRuntimeApi {
+    using DomainGet = void* (*)();
+    using DomainGetAssemblies = void** (*)(void* domain, size_t* count);
+    using AssemblyGetImage = void* (*)(void* assembly);
+    using ImageGetClassCount = size_t (*)(void* image);
+    using ImageGetClass = void* (*)(void* image, size_t index);
+    using ClassGetType = void* (*)(void* klass);
+    using ClassGetName = const char* (*)(void* klass);
+    using ThreadAttach = void* (*)(void* domain);
+    using ThreadDetach = void (*)(void* thread);
+
+    DomainGet domainGet = nullptr;
+    DomainGetAssemblies domainGetAssemblies = nullptr;
+    AssemblyGetImage assemblyGetImage = nullptr;
+    ImageGetClassCount imageGetClassCount = nullptr;
+    ImageGetClass imageGetClass = nullptr;
+    ClassGetType classGetType = nullptr;
+    ClassGetName classGetName = nullptr;
+    ClassGetName classGetNamespace = nullptr;
+    ThreadAttach threadAttach = nullptr;
+    ThreadDetach threadDetach = nullptr;
+
+    bool Load() {
+        HMODULE module = GetModuleHandleA("GameAssembly.dll");
+        if (!module) module = GetModuleHandleA(nullptr);
+        if (!module) return false;
+
+        auto bind = [module](auto& fn, const char* name) {
+            fn = reinterpret_cast<std::remove_reference_t<decltype(fn)>>(GetProcAddress(module, name));
+            return fn != nullptr;
+        };
+        return bind(domainGet, "il2cpp_domain_get") &&
+            bind(domainGetAssemblies, "il2cpp_domain_get_assemblies") &&
+            bind(assemblyGetImage, "il2cpp_assembly_get_image") &&
+            bind(imageGetClassCount, "il2cpp_image_get_class_count") &&
+            bind(imageGetClass, "il2cpp_image_get_class") &&
+            bind(classGetType, "il2cpp_class_get_type") &&
+            bind(classGetName, "il2cpp_class_get_name") &&
+            bind(classGetNamespace, "il2cpp_class_get_namespace") &&
+            bind(threadAttach, "il2cpp_thread_attach") &&
+            bind(threadDetach, "il2cpp_thread_detach");
+    }
+};
+
+static std::unordered_map<uintptr_t, std::string> g_typeDefinitionNames;
+
+static void BuildTypeDefinitionDirectory() {
+    Il2CppRuntimeApi api;
+    if (!api.Load()) {
+        LogLine("[TYPES] il2cpp exports not found, class references print as class#index / class@handle");
+        return;
+    }
+
+    void* domain = api.domainGet();
+    if (!domain) return;
+    void* thread = api.threadAttach(domain);
+
+    HANDLE process = GetCurrentProcess();
+    size_t assemblyCount = 0;
+    void** assemblies = api.domainGetAssemblies(domain, &assemblyCount);
+    for (size_t a = 0; assemblies && a < assemblyCount; a++) {
+        void* image = assemblies[a] ? api.assemblyGetImage(assemblies[a]) : nullptr;
+        if (!image) continue;
+
+        size_t classCount = api.imageGetClassCount(image);
+        for (size_t i = 0; i < classCount; i++) {
+            void* klass = api.imageGetClass(image, i);
+            void* byvalType = klass ? api.classGetType(klass) : nullptr;
+            void* typeData = nullptr;
+            if (!byvalType || !FastReadPointer(process, byvalType, 0, &typeData)) continue;
+
+            const char* name = api.classGetName(klass);
+            const char* nameSpace = api.classGetNamespace(klass);
+            if (!name) continue;
+            std::string fullName = (nameSpace && *nameSpace) ? std::string(nameSpace) + "::" + name : std::string(name);
+            g_typeDefinitionNames.emplace(reinterpret_cast<uintptr_t>(typeData), std::move(fullName));
         }
     }
+
+    if (thread) api.threadDetach(thread);
+    LogLine("[TYPES] %zu type definitions from %zu assemblies", g_typeDefinitionNames.size(), assemblyCount);
 }
 
-static void InitializeVectorTracking(const ClassInfo& classInfo) {
-    if (!g_options.enableVectorTracking) return;
+struct MethodRecord {
+    bool valid = false;
+    std::string name;
+    std::string line;
+    void* code = nullptr;
+    uint16_t flags = 0;
+    uint8_t parameterCount = 0;
+};
 
-    HANDLE hProcess = GetCurrentProcess();
+// Decoded Il2CppMethodInfo keyed by MethodInfo*. Inherited and shared
+// methods sit in many classes' tables; each is read, named and formatted
+// once per run. Records are never erased, so returned pointers stay valid.
+struct MethodInfoCache {
+    static constexpr size_t kShardCount = 16;
 
-    for (size_t i = 0; i < classInfo.fields.size(); i++) {
-        const auto& field = classInfo.fields[i];
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::unordered_map<void*, MethodRecord> records;
+    };
 
-        size_t offsetPos = field.find("[offset: +0x");
-        if (offsetPos != std::string::npos) {
-            std::string fieldName = field.substr(0, offsetPos - 1);
-            std::string offsetStr = field.substr(offsetPos + 12);
-            size_t endPos = offsetStr.find("]");
-            if (endPos != std::string::npos) {
-                offsetStr = offsetStr.substr(0, endPos);
+    Shard shards[kShardCount];
+    std::atomic<u64> hits{ 0 };
+    std::atomic<u64> misses{ 0 };
 
-                try {
-                    int offset = std::stoi(offsetStr, nullptr, 16);
-                    void* fieldAddr = static_cast<u8*>(classInfo.address) + offset;
+    Shard& ShardFor(void* key) {
+        return shards[(reinterpret_cast<uintptr_t>(key) >> 4) % kShardCount];
+    }
 
-                    Vector3 testVector;
-                    if (FastReadVector3(hProcess, fieldAddr, testVector)) {
-                        if (testVector.x >= -10000.0f && testVector.x <= 10000.0f &&
-                            testVector.y >= -1000.0f && testVector.y <= 3000.0f &&
-                            testVector.z >= -10000.0f && testVector.z <= 10000.0f) {
+    const MethodRecord* Find(void* key) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.records.find(key);
+        return it == shard.records.end() ? nullptr : &it->second;
+    }
 
-                            TrackedVector tracker;
-                            tracker.address = fieldAddr;
-                            tracker.currentValue = testVector;
-                            tracker.lastValue = testVector;
-                            tracker.name = fieldName;
-                            tracker.className = classInfo.fullName;
+    const MethodRecord* Insert(void* key, MethodRecord&& record) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        return &shard.records.emplace(key, std::move(record)).first->second;
+    }
+
+    size_t Size() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            total += shard.records.size();
+        }
+        return total;
+    }
+};
+
+static MethodInfoCache g_methodCache;
+
+static const char* PrimitiveTypeName(uint8_t typeEnum) {
+    switch (typeEnum) {
+    case IL2CPP_TYPE_VOID: return "void";
+    case IL2CPP_TYPE_BOOLEAN: return "bool";
+    case IL2CPP_TYPE_CHAR: return "char";
+    case IL2CPP_TYPE_I1: return "sbyte";
+    case IL2CPP_TYPE_U1: return "byte";
+    case IL2CPP_TYPE_I2: return "short";
+    case IL2CPP_TYPE_U2: return "ushort";
+    case IL2CPP_TYPE_I4: return "int";
+    case IL2CPP_TYPE_U4: return "uint";
+    case IL2CPP_TYPE_I8: return "long";
+    case IL2CPP_TYPE_U8: return "ulong";
+    case IL2CPP_TYPE_R4: return "float";
+    case IL2CPP_TYPE_R8: return "double";
+    case IL2CPP_TYPE_STRING: return "string";
+    case IL2CPP_TYPE_TYPEDBYREF: return "TypedReference";
+    case IL2CPP_TYPE_I: return "IntPtr";
+    case IL2CPP_TYPE_U: return "UIntPtr";
+    case IL2CPP_TYPE_OBJECT: return "object";
+    default: return nullptr;
+    }
+}
+
+static std::string HexName(const char* prefix, const void* value) {
+    LineBuffer text;
+    text << prefix << Hex(value);
+    return text.Str();
+}
+
+template <typename Layout>
+static std::string ReadClassName(HANDLE process, void* classPtr, const char* separator = ".") {
+    void* namePtr = nullptr;
+    void* nsPtr = nullptr;
+    std::string name, nameSpace;
+    if (!FastReadPointer(process, classPtr, Layout::kNameOff, &namePtr) || !namePtr ||
+        !FastReadString(process, namePtr, name, 200)) {
+        return "";
+    }
+    if (FastReadPointer(process, classPtr, Layout::kNsOff, &nsPtr) && nsPtr) {
+        FastReadString(process, nsPtr, nameSpace, 200);
+    }
+    return nameSpace.empty() ? name : (nameSpace + separator + name);
+}
+
+template <typename Layout>
+static std::string ResolveTypeName(HANDLE process, void* typePtr, int depth = 0);
+
+// "<A, B>" for an Il2CppGenericInst, or empty if it cannot be read.
+template <typename Layout>
+static std::string GenericArgumentList(HANDLE process, void* classInst, int depth) {
+    Il2CppGenericInst inst;
+    if (!classInst || !FastReadMemory(process, classInst, &inst, sizeof(inst)) ||
+        inst.typeArgc == 0 || inst.typeArgc > 16 || !inst.typeArgv) {
+        return "";
+    }
+
+    void* args[16];
+    if (!FastReadMemory(process, inst.typeArgv, args, inst.typeArgc * sizeof(void*))) {
+        return "";
+    }
+
+    std::string result = "<";
+    for (uint32_t i = 0; i < inst.typeArgc; i++) {
+        if (i > 0) result += ", ";
+        result += ResolveTypeName<Layout>(process, args[i], depth + 1);
+    }
+    return result + ">";
+}
+
+template <typename Layout>
+static std::string DecodeTypeName(HANDLE process, void* typePtr, int depth) {
+    Il2CppType type;
+    if (!FastReadMemory(process, typePtr, &type, sizeof(type))) {
+        return HexName("type@", typePtr);
+    }
+
+    uint8_t typeEnum = static_cast<uint8_t>((type.bits >> 16) & 0xFF);
+    if (const char* primitive = PrimitiveTypeName(typeEnum)) {
+        return primitive;
+    }
+
+    switch (typeEnum) {
+    case IL2CPP_TYPE_PTR:
+        return ResolveTypeName<Layout>(process, type.data, depth + 1) + "*";
+
+    case IL2CPP_TYPE_SZARRAY:
+        return ResolveTypeName<Layout>(process, type.data, depth + 1) + "[]";
+
+    case IL2CPP_TYPE_ARRAY: {
+        Il2CppArrayType arrayType;
+        if (!FastReadMemory(process, type.data, &arrayType, sizeof(arrayType))) {
+            return "Array";
+        }
+        std::string rank(arrayType.rank > 1 ? arrayType.rank - 1 : 0, ',');
+        return ResolveTypeName<Layout>(process, arrayType.etype, depth + 1) + "[" + rank + "]";
+    }
+
+    case IL2CPP_TYPE_VALUETYPE:
+    case IL2CPP_TYPE_CLASS: {
+        uintptr_t definition = reinterpret_cast<uintptr_t>(type.data);
+        auto it = g_typeDefinitionNames.find(definition);
+        if (it != g_typeDefinitionNames.end()) {
+            return it->second;
+        }
+        return definition < 0x10000 ? "class#" + std::to_string(definition) : HexName("class@", type.data);
+    }
+
+    case IL2CPP_TYPE_GENERICINST: {
+        Il2CppGenericClass genericClass;
+        if (!FastReadMemory(process, type.data, &genericClass, sizeof(genericClass))) {
+            return "GenericInst";
+        }
+
+        std::string baseName;
+        if (genericClass.cachedClass) {
+            baseName = ReadClassName<Layout>(process, genericClass.cachedClass);
+            size_t tick = baseName.find('`');
+            if (tick != std::string::npos) baseName.resize(tick);
+        }
+        if (baseName.empty()) baseName = HexName("generic@", type.data);
+
+        return baseName + GenericArgumentList<Layout>(process, genericClass.classInst, depth);
+    }
+
+    case IL2CPP_TYPE_VAR:
+        return "T";
+
+    case IL2CPP_TYPE_MVAR:
+        return "TMethod";
+
+    case IL2CPP_TYPE_FNPTR:
+        return "fnptr";
+
+    default:
+        return "type#" + std::to_string(typeEnum);
+    }
+}
+
+// Failed reads are cached too, so a bad slot is not retried by every class
+// that shares it.
+template <typename Layout>
+static const MethodRecord* ResolveMethod(HANDLE process, void* methodPtr) {
+    if (const MethodRecord* record = g_methodCache.Find(methodPtr)) {
+        g_methodCache.hits++;
+        return record;
+    }
+
+    g_methodCache.misses++;
+    MethodRecord record;
+    typename Layout::MethodInfo methodInfo;
+    if (FastReadMemory(process, methodPtr, &methodInfo, sizeof(methodInfo)) && methodInfo.name &&
+        FastReadString(process, methodInfo.name, record.name, 100) && !record.name.empty()) {
+        record.valid = true;
+        record.code = methodInfo.methodPointer;
+        record.flags = methodInfo.flags;
+        record.parameterCount = methodInfo.parameters_count;
+
+        LineBuffer line;
+        line << record.name << "() [addr: " << Hex(record.code) << ']';
+        record.line = line.Str();
+    }
+    return g_methodCache.Insert(methodPtr, std::move(record));
+}
+
+template <typename Layout>
+static std::string ResolveTypeName(HANDLE process, void* typePtr, int depth) {
+    if (!typePtr) return "?";
+    if (depth > 8) return "...";
+
+    std::string name;
+    if (g_typeNameCache.Find(typePtr, name)) {
+        g_typeNameCache.hits++;
+        return name;
+    }
+
+    g_typeNameCache.misses++;
+    name = DecodeTypeName<Layout>(process, typePtr, depth);
+    g_typeNameCache.Insert(typePtr, name);
+    return name;
+}
+
+// One node per class address in the inheritance graph. A node points at its
+// parent's node, so every descendant shares the already-resolved chain.
+struct ChainNode {
+    std::string fullName;
+    void* address;
+    std::shared_ptr<const ChainNode> parent;
+};
+
+struct ClassGraph {
+    std::mutex mtx;
+    std::unordered_map<uintptr_t, std::shared_ptr<const ChainNode>> nodes;
+};
+
+static ClassGraph g_classGraph;
+
+static std::shared_ptr<const ChainNode> FindChainNode(void* classPtr) {
+    std::lock_guard<std::mutex> lock(g_classGraph.mtx);
+    auto it = g_classGraph.nodes.find(reinterpret_cast<uintptr_t>(classPtr));
+    return it == g_classGraph.nodes.end() ? nullptr : it->second;
+}
+
+template <typename Layout>
+static std::shared_ptr<const ChainNode> ResolveChainNode(HANDLE process, void* classPtr,
+    const std::string& knownName = "", int depth = 0) {
+    if (!classPtr || depth > 32) return nullptr;
+
+    if (auto existing = FindChainNode(classPtr)) {
+        return existing;
+    }
+
+    std::string fullName = knownName.empty() ? ReadClassName<Layout>(process, classPtr, "::") : knownName;
+    if (fullName.empty()) return nullptr;
+
+    auto node = std::make_shared<ChainNode>();
+    node->fullName = fullName;
+    node->address = classPtr;
+
+    void* parentPtr = nullptr;
+    if (FastReadPointer(process, classPtr, Layout::kParentOff, &parentPtr) && parentPtr && parentPtr != classPtr) {
+        node->parent = ResolveChainNode<Layout>(process, parentPtr, "", depth + 1);
+    }
+
+    std::lock_guard<std::mutex> lock(g_classGraph.mtx);
+    return g_classGraph.nodes.emplace(reinterpret_cast<uintptr_t>(classPtr), node).first->second;
+}
+
+static void WriteInheritanceEdges(const std::string& path) {
+    std::ofstream edgeFile(path);
+    if (!edgeFile.is_open()) return;
+
+    std::lock_guard<std::mutex> lock(g_classGraph.mtx);
+    for (const auto& entry : g_classGraph.nodes) {
+        const ChainNode& node = *entry.second;
+        if (!node.parent) continue;
+        LineBuffer line;
+        line << Hex(node.address) << ' ' << Hex(node.parent->address)
+            << ' ' << node.fullName << " -> " << node.parent->fullName << '\n';
+        edgeFile.write(line.data, static_cast<std::streamsize>(line.size));
+    }
+}
+
+static bool IsImportantMethod(std::string_view methodName) {
+    for (const auto& targetMethod : g_targetMethodNames) {
+        if (methodName.find(targetMethod) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Watch clients get a Class record for every class stored, target or not;
+// RecordFoundAddress streams the fields and methods.
+static void PublishClassRecord(const ClassInfo& classInfo) {
+    if (!g_queryServer.HasWatchers()) return;
+    LineBuffer line;
+    QueryRecordLine(line, "Class", reinterpret_cast<uintptr_t>(classInfo.address), classInfo.fullName, {});
+    g_queryServer.Publish(line.View());
+}
+
+static void RecordFoundAddress(std::string_view name, std::string_view className,
+    std::string_view type, void* address, std::string_view signature) {
+    if (!g_options.enableAddressDiscovery) return;
+
+    FoundAddress foundAddr;
+    foundAddr.name = std::string(name);
+    foundAddr.className = std::string(className);
+    foundAddr.type = std::string(type);
+    foundAddr.address = address;
+    foundAddr.signature = std::string(signature);
+    foundAddr.isImportant = IsImportantMethod(name) ||
+        std::find(g_targetClassNames.begin(), g_targetClassNames.end(), className) != g_targetClassNames.end();
+
+    if (foundAddr.isImportant) {
+        std::lock_guard<std::mutex> lock(g_importantMutex);
+        if (g_importantEntries.size() < kImportantDisplayCount) {
+            foundAddr.importantSlot = static_cast<int>(g_importantEntries.size());
+            g_importantEntries.push_back({ foundAddr.type, foundAddr.name, foundAddr.className, address, 0 });
+            PublishImportantSnapshot();
+        }
+    }
+
+    g_retainedBytes += sizeof(FoundAddress) + name.size() + className.size() + type.size() + signature.size();
+    g_allFoundAddresses.Append(foundAddr, reinterpret_cast<uintptr_t>(address));
+    g_addressCount++;
+
+    if (type != "Class" && g_queryServer.HasWatchers()) {
+        LineBuffer line;
+        QueryRecordLine(line, type, reinterpret_cast<uintptr_t>(address), className, name);
+        g_queryServer.Publish(line.View());
+    }
+
+    if (foundAddr.isImportant) {
+        LogLine("[DOKS ADDRESS FOUND] %s::%s @ 0x%p (%s)", foundAddr.className.c_str(), foundAddr.name.c_str(),
+            address, foundAddr.type.c_str());
+
+        EntryBuffer addrOutput;
+        addrOutput << '[' << type << "] " << className << "::" << name << " @ " << Hex(address) << '\n';
+
+        if (g_options.enableFileGrouping) {
+            addrOutput << "  Signature: " << signature << '\n';
+            LineBuffer fileName;
+            fileName << "Kitay_Kazik_addresses_" << type << ".txt";
+            WriteFileImmediately(fileName.View(), addrOutput.View());
+        }
+        else {
+            WriteFileImmediately("Kitay_Kazik_current_addresses.txt", addrOutput.View());
+        }
+    }
+}
+
+// Every stored class answers as a Class record, whether or not it is a
+// target and whether or not address discovery is on; found fields and
+// methods come from g_allFoundAddresses. AnswerRecordQuery copies matches
+// out under the shard locks and writes them after.
+static size_t AnswerQuery(const QueryRequest& request, QueryChannel& channel) {
+    if (request.kind == kQueryStats) {
+        LineBuffer line;
+        line << "classes " << g_classCount.load() << "\naddresses " << g_addressCount.load()
+            << "\nstrings " << g_stringCount.load() << "\nwatchers " << g_queryServer.watcherCount.load()
+            << "\ncomplete " << (g_dumpComplete ? 1 : 0) << '\n';
+        channel.Write(line.View());
+        return 5;
+    }
+
+    return AnswerRecordQuery(request, channel, [](auto&& emit) {
+        g_allClasses.ForEach([&](const ClassInfo& classInfo) {
+            emit("Class", reinterpret_cast<uintptr_t>(classInfo.address), classInfo.fullName, std::string_view());
+        });
+        g_allFoundAddresses.ForEach([&](const FoundAddress& found) {
+            if (found.type == "Class") return;
+            emit(found.type, reinterpret_cast<uintptr_t>(found.address), found.className, found.name);
+        });
+    });
+}
+
+static void StartQueryServer() {
+    if (!g_options.enableQueryServer) return;
+
+    if (g_queryServer.Start(g_options.queryEndpoint, AnswerQuery)) {
+        LogLine("[QUERY] Listening on %s", g_queryServer.path.c_str());
+    }
+    else {
+        LogLine("[QUERY] Failed to listen on %s", QueryEndpointPath(g_options.queryEndpoint).c_str());
+    }
+}
+
+// Keeps answering for queryLingerSeconds after the dump so late clients
+// still get results, unless the console monitor already kept us alive.
+static void StopQueryServer(bool lingered) {
+    if (!g_queryServer.running) return;
+
+    if (!lingered && g_options.queryLingerSeconds > 0) {
+        LogLine("[QUERY] Serving results for %d more seconds", g_options.queryLingerSeconds);
+        std::this_thread::sleep_for(std::chrono::seconds(g_options.queryLingerSeconds));
+    }
+
+    g_queryServer.Stop();
+    LogLine("[QUERY] Stopped (%llu watch bytes dropped)",
+        static_cast<unsigned long long>(g_queryServer.droppedBytes.load()));
+}
+
+static void InitializeVectorTracking(const ClassInfo& classInfo) {
+    if (!g_options.enableVectorTracking) return;
+
+    HANDLE hProcess = GetCurrentProcess();
+
+    for (size_t i = 0; i < classInfo.fields.size(); i++) {
+        const auto& field = classInfo.fields[i];
+
+        size_t offsetPos = field.find("[offset: +0x");
+        if (offsetPos != std::string::npos) {
+            std::string fieldName = field.substr(0, offsetPos - 1);
+            std::string offsetStr = field.substr(offsetPos + 12);
+            size_t endPos = offsetStr.find("]");
+            if (endPos != std::string::npos) {
+                offsetStr = offsetStr.substr(0, endPos);
+
+                try {
+                    int offset = std::stoi(offsetStr, nullptr, 16);
+                    void* fieldAddr = static_cast<u8*>(classInfo.address) + offset;
+
+                    Vector3 testVector;
+                    if (FastReadVector3(hProcess, fieldAddr, testVector)) {
+                        if (testVector.x >= -10000.0f && testVector.x <= 10000.0f &&
+                            testVector.y >= -1000.0f && testVector.y <= 3000.0f &&
+                            testVector.z >= -10000.0f && testVector.z <= 10000.0f) {
+
+                            TrackedVector tracker;
+                            tracker.address = fieldAddr;
+                            tracker.currentValue = testVector;
+                            tracker.lastValue = testVector;
+                            tracker.name = fieldName;
+                            tracker.className = classInfo.fullName;
                             tracker.context = "Field vector in " + classInfo.fullName;
                             tracker.changeCount = 0;
                             tracker.lastUpdate = std::chrono::steady_clock::now();
@@ -518,8 +1793,7 @@ static void InitializeVectorTracking(const ClassInfo& classInfo) {
                                 (tracker.isDamageVector && g_options.enableDamageVectorTracking) ||
                                 (!tracker.isPositionVector && !tracker.isDamageVector)) {
 
-                                std::lock_guard<std::mutex> lock(g_dataMutex);
-                                g_allTrackedVectors.push_back(tracker);
+                                g_allTrackedVectors.Append(tracker, reinterpret_cast<uintptr_t>(fieldAddr));
 
                                 LogLine("[VECTOR TRACK] %s::%s @ 0x%p: %s",
                                     classInfo.fullName.c_str(), fieldName.c_str(), fieldAddr,
@@ -540,9 +1814,12 @@ static void MonitorVectorChanges() {
 
     HANDLE hProcess = GetCurrentProcess();
 
-    std::lock_guard<std::mutex> lock(g_dataMutex);
+    // Entries and log lines are written after the walk, so no shard lock is
+    // held across file I/O.
+    std::vector<std::string> changeEntries;
+    std::vector<std::string> logLines;
 
-    for (auto& tracker : g_allTrackedVectors) {
+    g_allTrackedVectors.ForEach([&](TrackedVector& tracker) {
         Vector3 newValue;
         if (FastReadVector3(hProcess, tracker.address, newValue)) {
 
@@ -553,43 +1830,250 @@ static void MonitorVectorChanges() {
                 tracker.lastUpdate = std::chrono::steady_clock::now();
                 g_vectorChangeCount++;
 
-                std::ostringstream changeEntry;
+                EntryBuffer changeEntry;
                 changeEntry << "[VECTOR CHANGE " << tracker.changeCount << "] "
-                    << tracker.className << "::" << tracker.name
-                    << " @ 0x" << std::hex << tracker.address << std::endl;
-                changeEntry << "  From: " << tracker.lastValue.toString()
-                    << " To: " << tracker.currentValue.toString() << std::endl;
-                changeEntry << "  Type: " << (tracker.isPositionVector ? "Position" :
-                    tracker.isDamageVector ? "Damage" : "Unknown") << std::endl;
+                    << tracker.className << "::" << tracker.name << " @ " << Hex(tracker.address) << '\n';
+                changeEntry << "  From: ";
+                tracker.lastValue.FormatTo(changeEntry);
+                changeEntry << " To: ";
+                tracker.currentValue.FormatTo(changeEntry);
+                changeEntry << "\n  Type: " << (tracker.isPositionVector ? "Position" :
+                    tracker.isDamageVector ? "Damage" : "Unknown") << '\n';
 
-                tracker.changeHistory.push_back(changeEntry.str());
+                tracker.changeHistory.push_back(changeEntry.Str());
 
                 if (g_options.enableVectorChangeLogging) {
-                    WriteFileImmediately("Kitay_Kazik_vector_changes.txt", changeEntry.str());
+                    changeEntries.push_back(tracker.changeHistory.back());
                 }
 
-                LogLine("[VECTOR CHANGE] %s::%s: %s -> %s",
-                    tracker.className.c_str(), tracker.name.c_str(),
-                    tracker.lastValue.toString().c_str(),
-                    tracker.currentValue.toString().c_str());
+                LineBuffer logLine;
+                logLine << "[VECTOR CHANGE] " << tracker.className << "::" << tracker.name << ": ";
+                tracker.lastValue.FormatTo(logLine);
+                logLine << " -> ";
+                tracker.currentValue.FormatTo(logLine);
+                logLines.push_back(logLine.Str());
+            }
+        }
+    });
+
+    for (const auto& entry : changeEntries) {
+        WriteFileImmediately("Kitay_Kazik_vector_changes.txt", entry);
+    }
+    for (const auto& line : logLines) {
+        LogLine("%s", line.c_str());
+    }
+}
+
+static void ClassifyFieldName(ScanArena& arena, ClassInfo& classInfo, std::string_view fieldName) {
+    ArenaString lowerField(fieldName.begin(), fieldName.end(), ArenaAllocator<char>(arena));
+    std::transform(lowerField.begin(), lowerField.end(), lowerField.begin(), ::tolower);
+
+    if (lowerField.find("position") != ArenaString::npos ||
+        lowerField.find("pos") != ArenaString::npos ||
+        lowerField.find("transform") != ArenaString::npos ||
+        lowerField.find("location") != ArenaString::npos) {
+        classInfo.hasPositionData = true;
+    }
+
+    if (lowerField.find("damage") != ArenaString::npos ||
+        lowerField.find("health") != ArenaString::npos ||
+        lowerField.find("hp") != ArenaString::npos) {
+        classInfo.hasDamageData = true;
+    }
+}
+
+// Member layout of the first instantiation seen of a generic definition,
+// keyed by Il2CppGenericClass::type (the definition's index or handle).
+// Later instantiations take member names from here instead of re-reading
+// them, and are written as a diff against the lines printed for it.
+struct GenericFamily {
+    int classNumber = 0;
+    std::string fullName;
+    std::vector<std::string> fieldNames;
+    std::vector<std::string> methodNames;
+    std::vector<std::string> fields;
+    std::vector<std::string> methods;
+};
+
+static std::mutex g_genericMutex;
+static std::unordered_map<uintptr_t, std::shared_ptr<const GenericFamily>> g_genericFamilies;
+static std::atomic<u64> g_genericFolded{ 0 };
+static std::atomic<u64> g_genericLinesSaved{ 0 };
+
+static std::shared_ptr<const GenericFamily> FindGenericFamily(uintptr_t key) {
+    std::lock_guard<std::mutex> lock(g_genericMutex);
+    auto it = g_genericFamilies.find(key);
+    return it == g_genericFamilies.end() ? nullptr : it->second;
+}
+
+// Registers the family on its first instantiation; folds later ones whose
+// member counts still match. Target classes are always written in full.
+static void FoldGenericInstance(ClassInfo& classInfo, uintptr_t key, const std::shared_ptr<const GenericFamily>& family,
+    std::vector<std::string>&& fieldNames, std::vector<std::string>&& methodNames, int classNumber) {
+    if (!family) {
+        if (fieldNames.size() != classInfo.fields.size() || methodNames.size() != classInfo.methods.size()) return;
+
+        auto created = std::make_shared<GenericFamily>();
+        created->classNumber = classNumber;
+        created->fullName = classInfo.fullName + classInfo.genericArgs;
+        created->fieldNames = std::move(fieldNames);
+        created->methodNames = std::move(methodNames);
+        created->fields = classInfo.fields;
+        created->methods = classInfo.methods;
+
+        std::lock_guard<std::mutex> lock(g_genericMutex);
+        g_genericFamilies.emplace(key, std::move(created));
+        return;
+    }
+
+    if (classInfo.isTargetClass || !g_options.enableTotalDump ||
+        family->fields.size() != classInfo.fields.size() || family->methods.size() != classInfo.methods.size()) {
+        return;
+    }
+
+    auto diff = [&](const std::vector<std::string>& shared, const std::vector<std::string>& own) {
+        for (size_t i = 0; i < own.size(); i++) {
+            if (own[i] == shared[i]) {
+                classInfo.genericShared++;
+            }
+            else {
+                classInfo.genericDiffs.push_back(own[i]);
+            }
+        }
+    };
+    diff(family->fields, classInfo.fields);
+    diff(family->methods, classInfo.methods);
+
+    classInfo.genericOf = family->classNumber;
+    classInfo.genericOfName = family->fullName;
+    g_genericFolded++;
+    g_genericLinesSaved += classInfo.genericShared;
+}
+
+static bool MatchTargetClass(ClassInfo& classInfo) {
+    for (const auto& targetName : g_targetClassNames) {
+        if (classInfo.name.find(targetName) != std::string::npos ||
+            classInfo.fullName.find(targetName) != std::string::npos) {
+            classInfo.isTargetClass = true;
+            g_targetClassCount++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Writes the class block to the dump sinks selected by the options and
+// returns its offset in the indexed dump, or kDumpIndexNoOffset.
+static u64 EmitClassBlock(ScanArena& arena, const ClassInfo& classInfo, int classNumber) {
+    bool isTarget = classInfo.isTargetClass;
+    u64 dumpOffset = kDumpIndexNoOffset;
+
+    if (g_options.enableRealTimeOutput &&
+        ((g_options.enableTotalDump) ||
+            (g_options.enableImportantDump && (isTarget || classInfo.hasPositionData || classInfo.hasDamageData)))) {
+
+        ArenaString classOutput{ ArenaAllocator<char>(arena) };
+        classOutput += "[CLASS ";
+        AppendDec(classOutput, classNumber);
+        classOutput += "] ";
+        classOutput += classInfo.fullName;
+        classOutput += classInfo.genericArgs;
+        if (classInfo.address) {
+            classOutput += " @ 0x";
+            AppendHex(classOutput, reinterpret_cast<uintptr_t>(classInfo.address));
+        }
+        else {
+            char token[32];
+            snprintf(token, sizeof(token), " [token: 0x%08x]", classInfo.token);
+            classOutput += token;
+        }
+        classOutput += "\n  Target: ";
+        classOutput += classInfo.isTargetClass ? "YES" : "NO";
+        classOutput += " | Position: ";
+        classOutput += classInfo.hasPositionData ? "YES" : "NO";
+        classOutput += " | Damage: ";
+        classOutput += classInfo.hasDamageData ? "YES" : "NO";
+        classOutput += "\n";
+
+        if (!classInfo.parentChain.empty()) {
+            classOutput += "  Parents: ";
+            for (size_t i = 0; i < classInfo.parentChain.size(); i++) {
+                if (i > 0) classOutput += " -> ";
+                classOutput += classInfo.parentChain[i];
+            }
+            classOutput += "\n";
+        }
+
+        auto appendSection = [&](const char* title, const std::vector<std::string>& lines) {
+            classOutput += "  ";
+            classOutput += title;
+            classOutput += " (";
+            AppendDec(classOutput, static_cast<long long>(lines.size()));
+            classOutput += "):\n";
+            for (const auto& line : lines) {
+                classOutput += "    ";
+                classOutput += line;
+                classOutput += "\n";
+            }
+        };
+
+        if (classInfo.genericOf) {
+            classOutput += "  Generic: instance of [CLASS ";
+            AppendDec(classOutput, classInfo.genericOf);
+            classOutput += "] ";
+            classOutput += classInfo.genericOfName;
+            classOutput += ", ";
+            AppendDec(classOutput, static_cast<long long>(classInfo.genericShared));
+            classOutput += " members shared\n";
+            if (!classInfo.genericDiffs.empty()) {
+                appendSection("Differs", classInfo.genericDiffs);
+            }
+        }
+        else if (g_options.enableTotalDump || isTarget) {
+            appendSection("Fields", classInfo.fields);
+            appendSection("Methods", classInfo.methods);
+        }
+
+        if (g_options.enableStringRelation && !classInfo.relatedStrings.empty()) {
+            appendSection("Related Strings", classInfo.relatedStrings);
+        }
+
+        classOutput += "\n";
+
+        if (g_options.enableFileGrouping) {
+            if (g_options.enableTotalDump) {
+                dumpOffset = WriteFileImmediately("Kitay_Kazik_total_dump.txt", classOutput);
             }
+            if (g_options.enableImportantDump && (isTarget || classInfo.hasPositionData || classInfo.hasDamageData)) {
+                u64 importantOffset = WriteFileImmediately("Kitay_Kazik_important_dump.txt", classOutput);
+                if (!g_options.enableTotalDump) dumpOffset = importantOffset;
+            }
+        }
+        else {
+            dumpOffset = WriteFileImmediately("Kitay_Kazik_complete_analysis.txt", classOutput);
         }
     }
+
+    return dumpOffset;
 }
 
+template <typename Layout>
 static void AnalyzeClassWithOptions(HANDLE process, void* classPtr, int classNumber) {
     if (!classPtr) return;
 
+    ArenaScope classScope(PhaseArena());
+    ScanArena& arena = classScope.arena;
+
     void* namePtr = nullptr;
     void* nsPtr = nullptr;
     std::string name, nameSpace;
 
-    if (!FastReadPointer(process, classPtr, kNameOff, &namePtr) || !namePtr ||
+    if (!FastReadPointer(process, classPtr, Layout::kNameOff, &namePtr) || !namePtr ||
         !FastReadString(process, namePtr, name, 200) || name.length() < 2) {
         return;
     }
 
-    FastReadPointer(process, classPtr, kNsOff, &nsPtr);
+    FastReadPointer(process, classPtr, Layout::kNsOff, &nsPtr);
     if (nsPtr) {
         FastReadString(process, nsPtr, nameSpace, 200);
     }
@@ -600,19 +2084,51 @@ static void AnalyzeClassWithOptions(HANDLE process, void* classPtr, int classNum
     classInfo.fullName = nameSpace.empty() ? name : (nameSpace + "::" + name);
     classInfo.address = classPtr;
 
-    bool isTarget = false;
-    for (const auto& targetName : g_targetClassNames) {
-        if (name.find(targetName) != std::string::npos ||
-            classInfo.fullName.find(targetName) != std::string::npos) {
-            classInfo.isTargetClass = true;
-            isTarget = true;
-            g_targetClassCount++;
+    uintptr_t genericKey = 0;
+    std::shared_ptr<const GenericFamily> family;
+    std::vector<std::string> genericFieldNames;
+    std::vector<std::string> genericMethodNames;
+    void* genericClassPtr = nullptr;
+    Il2CppGenericClass genericClass;
+    if (g_options.enableGenericFolding &&
+        FastReadPointer(process, classPtr, Layout::kGenericClassOff, &genericClassPtr) && genericClassPtr &&
+        FastReadMemory(process, genericClassPtr, &genericClass, sizeof(genericClass)) &&
+        genericClass.type && genericClass.classInst) {
+        genericKey = reinterpret_cast<uintptr_t>(genericClass.type);
+        classInfo.genericArgs = GenericArgumentList<Layout>(process, genericClass.classInst, 0);
+        family = FindGenericFamily(genericKey);
+    }
 
-            RecordFoundAddress(name, classInfo.fullName, "Class", classPtr,
-                "IL2CPP Class Structure realno @ " + std::to_string(reinterpret_cast<uintptr_t>(classPtr)));
+    bool isTarget = MatchTargetClass(classInfo);
+    if (isTarget) {
+        LineBuffer signature;
+        signature << "IL2CPP Class Structure realno @ " << reinterpret_cast<uintptr_t>(classPtr);
+        RecordFoundAddress(name, classInfo.fullName, "Class", classPtr, signature.View());
 
-            LogLine("[TARGET CLASS] Found: %s @ 0x%p", classInfo.fullName.c_str(), classPtr);
-            break;
+        LogLine("[TARGET CLASS] Found: %s @ 0x%p", classInfo.fullName.c_str(), classPtr);
+    }
+
+    if (g_options.enableConnectionAnalysis) {
+        auto node = ResolveChainNode<Layout>(process, classPtr, classInfo.fullName);
+        for (auto parent = node ? node->parent : nullptr; parent; parent = parent->parent) {
+            classInfo.parentChain.push_back(parent->fullName);
+        }
+
+        if (!classInfo.parentChain.empty()) {
+            const std::string& parentName = classInfo.parentChain.front();
+            classInfo.connections.push_back("Inherits -> " + parentName);
+
+            ConnectionInfo connection;
+            connection.fromClass = classInfo.fullName;
+            connection.toClass = parentName;
+            connection.connectionType = "Inherits";
+            connection.details = HexName("Parent pointer @ +",
+                reinterpret_cast<void*>(static_cast<uintptr_t>(Layout::kParentOff)));
+            {
+                std::lock_guard<std::mutex> lock(g_dataMutex);
+                g_allConnections.push_back(connection);
+            }
+            g_connectionCount++;
         }
     }
 
@@ -622,138 +2138,587 @@ static void AnalyzeClassWithOptions(HANDLE process, void* classPtr, int classNum
 
     uint16_t fieldCount = 0;
     void* fieldsPtr = nullptr;
-    if (FastReadUInt16(process, static_cast<u8*>(classPtr) + kFieldCountOff, &fieldCount) &&
+    if (FastReadUInt16(process, static_cast<u8*>(classPtr) + Layout::kFieldCountOff, &fieldCount) &&
         fieldCount > 0 && fieldCount < 500 &&
-        FastReadPointer(process, classPtr, kFieldsOff, &fieldsPtr) && fieldsPtr) {
+        FastReadPointer(process, classPtr, Layout::kFieldsOff, &fieldsPtr) && fieldsPtr) {
+
+        bool reuseFieldNames = family && family->fieldNames.size() == fieldCount;
 
         for (uint16_t i = 0; i < fieldCount; i++) {
-            Il2CppFieldInfo fieldInfo;
-            void* fieldAddr = static_cast<u8*>(fieldsPtr) + (i * sizeof(Il2CppFieldInfo));
+            typename Layout::FieldInfo fieldInfo;
+            void* fieldAddr = static_cast<u8*>(fieldsPtr) + (i * sizeof(fieldInfo));
 
             if (FastReadMemory(process, fieldAddr, &fieldInfo, sizeof(fieldInfo)) && fieldInfo.name) {
-                std::string fieldName;
-                if (FastReadString(process, fieldInfo.name, fieldName, 100)) {
+                ArenaString nameBuffer{ ArenaAllocator<char>(arena) };
+                std::string_view fieldName;
+                if (reuseFieldNames) {
+                    fieldName = family->fieldNames[i];
+                }
+                else if (FastReadString(process, fieldInfo.name, nameBuffer, 100)) {
+                    fieldName = std::string_view(nameBuffer.data(), nameBuffer.size());
+                    if (genericKey) genericFieldNames.emplace_back(fieldName);
+                }
 
-                    std::ostringstream fieldEntry;
-                    fieldEntry << fieldName << " [offset: +0x" << std::hex << fieldInfo.offset << "]";
-                    classInfo.fields.push_back(fieldEntry.str());
+                if (!fieldName.empty()) {
 
-                    if (isTarget || g_options.enableTotalDump) {
-                        std::ostringstream signature;
-                        signature << "Field offset +0x" << std::hex << fieldInfo.offset << " in " << classInfo.fullName;
-                        RecordFoundAddress(fieldName, classInfo.fullName, "Field",
-                            static_cast<u8*>(classPtr) + fieldInfo.offset, signature.str());
+                    HexArg fieldOffset = Hex(static_cast<u32>(fieldInfo.offset));
+                    LineBuffer fieldEntry;
+                    fieldEntry << fieldName << " [offset: +" << fieldOffset << ']';
+                    if (g_options.enableFieldTypes && fieldInfo.type) {
+                        fieldEntry << " [type: " << ResolveTypeName<Layout>(process, fieldInfo.type) << ']';
                     }
+                    classInfo.fields.push_back(fieldEntry.Str());
 
-                    std::string lowerField = fieldName;
-                    std::transform(lowerField.begin(), lowerField.end(), lowerField.begin(), ::tolower);
-
-                    if (lowerField.find("position") != std::string::npos ||
-                        lowerField.find("pos") != std::string::npos ||
-                        lowerField.find("transform") != std::string::npos ||
-                        lowerField.find("location") != std::string::npos) {
-                        classInfo.hasPositionData = true;
+                    if (isTarget || g_options.enableTotalDump) {
+                        LineBuffer signature;
+                        signature << "Field offset +" << fieldOffset << " in " << classInfo.fullName;
+                        RecordFoundAddress(fieldName, classInfo.fullName, "Field",
+                            static_cast<u8*>(classPtr) + fieldInfo.offset, signature.View());
                     }
 
-                    if (lowerField.find("damage") != std::string::npos ||
-                        lowerField.find("health") != std::string::npos ||
-                        lowerField.find("hp") != std::string::npos) {
-                        classInfo.hasDamageData = true;
-                    }
+                    ClassifyFieldName(arena, classInfo, fieldName);
                 }
             }
         }
     }
 
+    ArenaVector<std::pair<ArenaString, void*>> methodAddresses{ ArenaAllocator<std::pair<ArenaString, void*>>(arena) };
     uint16_t methodCount = 0;
     void* methodsPtr = nullptr;
-    if (FastReadUInt16(process, static_cast<u8*>(classPtr) + kMethodCountOff, &methodCount) &&
+    if (FastReadUInt16(process, static_cast<u8*>(classPtr) + Layout::kMethodCountOff, &methodCount) &&
         methodCount > 0 && methodCount < 1000 &&
-        FastReadPointer(process, classPtr, kMethodsOff, &methodsPtr) && methodsPtr) {
+        FastReadPointer(process, classPtr, Layout::kMethodsOff, &methodsPtr) && methodsPtr) {
+
+        bool reuseMethodNames = family && family->methodNames.size() == methodCount;
 
         for (uint16_t i = 0; i < methodCount; i++) {
             void* methodPtr = nullptr;
             void* methodPtrAddr = static_cast<u8*>(methodsPtr) + (i * sizeof(void*));
 
             if (FastReadPointer(process, methodPtrAddr, 0, &methodPtr) && methodPtr) {
-                Il2CppMethodInfo methodInfo;
-                if (FastReadMemory(process, methodPtr, &methodInfo, sizeof(methodInfo)) && methodInfo.name) {
-                    std::string methodName;
-                    if (FastReadString(process, methodInfo.name, methodName, 100)) {
-
-                        std::ostringstream methodEntry;
-                        methodEntry << methodName << "() [addr: 0x" << std::hex << methodInfo.methodPointer << "]";
-                        classInfo.methods.push_back(methodEntry.str());
-
-                        if (IsImportantMethod(methodName) || isTarget || g_options.enableTotalDump) {
-                            std::ostringstream signature;
-                            signature << "Method in " << classInfo.fullName << " - IL2CPP MethodInfo @ 0x"
-                                << std::hex << methodPtr << ", Code @ 0x" << methodInfo.methodPointer;
-
-                            RecordFoundAddress(methodName, classInfo.fullName, "Method",
-                                methodInfo.methodPointer, signature.str());
+                std::string_view methodName;
+                void* codePointer = nullptr;
+                const MethodRecord* record = reuseMethodNames ? g_methodCache.Find(methodPtr) :
+                    ResolveMethod<Layout>(process, methodPtr);
+
+                if (record) {
+                    if (reuseMethodNames) g_methodCache.hits++;
+                    if (record->valid) {
+                        methodName = record->name;
+                        codePointer = record->code;
+                        if (genericKey && !family) genericMethodNames.push_back(record->name);
+                    }
+                }
+                else if (FastReadPointer(process, methodPtr, 0, &codePointer)) {
+                    // Inflated methods keep the definition's name; only the
+                    // code pointer can differ, and it is the first word.
+                    methodName = family->methodNames[i];
+                }
+
+                if (!methodName.empty()) {
+                    if (record) {
+                        classInfo.methods.push_back(record->line);
+                    }
+                    else {
+                        LineBuffer methodEntry;
+                        methodEntry << methodName << "() [addr: " << Hex(codePointer) << ']';
+                        classInfo.methods.push_back(methodEntry.Str());
+                    }
+                    if (g_options.enableDumpIndex) {
+                        methodAddresses.emplace_back(ArenaString(methodName.data(), methodName.size(),
+                            ArenaAllocator<char>(arena)), codePointer);
+                    }
+
+                    if (IsImportantMethod(methodName) || isTarget || g_options.enableTotalDump) {
+                        LineBuffer signature;
+                        signature << "Method in " << classInfo.fullName << " - IL2CPP MethodInfo @ "
+                            << Hex(methodPtr) << ", Code @ " << Hex(codePointer);
+                        if (record) {
+                            signature << ", " << static_cast<int>(record->parameterCount) << " params, flags "
+                                << Hex(record->flags);
                         }
+
+                        RecordFoundAddress(methodName, classInfo.fullName, "Method",
+                            codePointer, signature.View());
                     }
                 }
             }
         }
     }
 
-    InitializeVectorTracking(classInfo);
+    if (genericKey) {
+        FoldGenericInstance(classInfo, genericKey, family, std::move(genericFieldNames),
+            std::move(genericMethodNames), classNumber);
+    }
+
+    InitializeVectorTracking(classInfo);
+
+    if (classInfo.isTargetClass) {
+        std::lock_guard<std::mutex> lock(g_dataMutex);
+        g_targetClasses[classInfo.fullName] = classInfo;
+    }
+
+    PublishClassRecord(classInfo);
+    g_allClasses.Append(classInfo, reinterpret_cast<uintptr_t>(classPtr));
+    g_classCount++;
+
+    u64 dumpOffset = EmitClassBlock(arena, classInfo, classNumber);
+
+    if (g_options.enableDumpIndex) {
+        uintptr_t classAddress = reinterpret_cast<uintptr_t>(classPtr);
+        g_indexRecords.Append({ classInfo.fullName, 0, kIndexClass, classAddress, dumpOffset });
+        for (const auto& method : methodAddresses) {
+            std::string qualified = classInfo.fullName + "::";
+            qualified.append(method.first.data(), method.first.size());
+            g_indexRecords.Append({ std::move(qualified),
+                static_cast<uint16_t>(classInfo.fullName.size() + 2), kIndexMethod,
+                reinterpret_cast<uintptr_t>(method.second), dumpOffset });
+        }
+    }
+}
+
+// Version from the global-metadata.dat header, 0 until MetadataCatalogPass
+// has opened it.
+static int g_metadataVersion = 0;
+
+static void GovernorYield(size_t bytes);
+
+// Builds the catalog from global-metadata.dat instead of scanning the heap.
+// Classes go through the same stores, sinks and index as live ones, with
+// metadata tokens where a live run has addresses.
+static bool MetadataCatalogPass() {
+    if (g_options.metadataPath.empty()) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    MetadataFile metadata;
+    std::string error;
+    if (!metadata.Open(g_options.metadataPath.c_str(), error)) {
+        LogLine("[METADATA] %s: %s, falling back to heap discovery", g_options.metadataPath.c_str(), error.c_str());
+        return false;
+    }
+
+    LogLine("[METADATA] %s: version %d (layout %s), %u types, %u fields, %u methods",
+        g_options.metadataPath.c_str(), metadata.version, metadata.layout->name,
+        metadata.typeCount, metadata.fieldCount, metadata.methodCount);
+    g_metadataVersion = metadata.version;
+
+    int classNumber = 0;
+    ParseMetadataClasses(metadata, g_options.metadataWorkers, [&](const MetadataClass& cls) {
+        ArenaScope classScope(PhaseArena());
+
+        ClassInfo classInfo;
+        classInfo.name = std::string(cls.name);
+        classInfo.nameSpace = std::string(cls.nameSpace);
+        classInfo.fullName = cls.FullName();
+        classInfo.address = nullptr;
+        classInfo.token = cls.token;
+
+        bool isTarget = MatchTargetClass(classInfo);
+        if (isTarget) {
+            RecordFoundAddress(classInfo.name, classInfo.fullName, "Class", nullptr,
+                HexName("Metadata type token ", reinterpret_cast<void*>(static_cast<uintptr_t>(cls.token))));
+            LogLine("[TARGET CLASS] Found: %s (token 0x%08x)", classInfo.fullName.c_str(), cls.token);
+        }
+
+        if (g_options.enableImportantDump && !g_options.enableTotalDump && !isTarget) {
+            return;
+        }
+
+        for (const auto& field : cls.fields) {
+            classInfo.fields.push_back(MetadataFieldLine(field));
+            ClassifyFieldName(classScope.arena, classInfo, field.name);
+        }
+        for (const auto& method : cls.methods) {
+            classInfo.methods.push_back(MetadataMethodLine(method));
+        }
+
+        if (classInfo.isTargetClass) {
+            std::lock_guard<std::mutex> lock(g_dataMutex);
+            g_targetClasses[classInfo.fullName] = classInfo;
+        }
+
+        u64 dumpOffset = EmitClassBlock(classScope.arena, classInfo, ++classNumber);
+
+        if (g_options.enableDumpIndex) {
+            g_indexRecords.Append({ classInfo.fullName, 0, kIndexClass, cls.token, dumpOffset });
+            for (const auto& method : cls.methods) {
+                g_indexRecords.Append({ classInfo.fullName + "::" + std::string(method.name),
+                    static_cast<uint16_t>(classInfo.fullName.size() + 2), kIndexMethod, method.token, dumpOffset });
+            }
+        }
+
+        PublishClassRecord(classInfo);
+        g_allClasses.Append(std::move(classInfo));
+        g_classCount++;
+        GovernorYield(0);
+    }, [](const auto& work) {
+        u64 cycles = WorkerThreadBegin();
+        work();
+        WorkerChargeCycles(cycles);
+    });
+
+    u64 elapsedMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    LogLine("[METADATA] %d classes cataloged in %llu ms", g_classCount.load(), static_cast<unsigned long long>(elapsedMs));
+    return true;
+}
+
+// Keeps the scan inside its CPU budget. Work is split into slices; at each
+// yield point the governor compares the CPU time the scan thread and the
+// helper threads (g_workerCycles) used in the slice with what the budget
+// allows for that wall time, and the scan thread sleeps off the excess.
+// Helpers stall once the scan thread stops feeding them. Chunk sizes follow
+// the scan thread's own throughput so yield points stay a few milliseconds
+// apart regardless of how expensive the scan is.
+struct ScanGovernor {
+    static constexpr u64 kSliceMs = 20;
+    static constexpr u64 kChunkTargetMs = 2;
+    static constexpr size_t kMinChunk = 16 * 1024;
+    static constexpr size_t kMaxChunk = 1024 * 1024;
+
+    std::chrono::steady_clock::time_point runStart;
+    std::chrono::steady_clock::time_point sliceStart;
+    u64 sliceCyclesStart = 0;
+    u64 sliceWorkerCyclesStart = 0;
+    double cyclesPerMs = 0.0;
+    u64 sliceBytes = 0;
+    double bytesPerCpuMs = 0.0;
+    std::atomic<u64> throttledMs{ 0 };
+    std::atomic<u64> yieldCount{ 0 };
+    std::atomic<u64> bytesScanned{ 0 };
+};
+
+static ScanGovernor g_governor;
+
+// Cycles per millisecond of thread CPU time, from short spins against the
+// wall clock. A preempted spin reads low, so the best of a few is kept.
+static double CalibrateThreadCycles() {
+    double best = 0.0;
+    for (int i = 0; i < 3; i++) {
+        auto start = std::chrono::steady_clock::now();
+        u64 startCycles = ThreadCycles();
+        std::chrono::steady_clock::time_point now;
+        do {
+            now = std::chrono::steady_clock::now();
+        } while (now - start < std::chrono::milliseconds(5));
+        double wallMs = std::chrono::duration<double, std::milli>(now - start).count();
+        best = (std::max)(best, static_cast<double>(ThreadCycles() - startCycles) / wallMs);
+    }
+    return best;
+}
+
+static double CyclesToMs(u64 cycles) {
+    if (g_governor.cyclesPerMs <= 0.0) return 0.0;
+    return static_cast<double>(cycles) / g_governor.cyclesPerMs;
+}
+
+static void GovernorBegin() {
+    SetThreadPriority(GetCurrentThread(), g_options.scanThreadPriority);
+    g_governor.runStart = std::chrono::steady_clock::now();
+    g_governor.sliceStart = g_governor.runStart;
+    g_governor.cyclesPerMs = CalibrateThreadCycles();
+    g_governor.sliceCyclesStart = ThreadCycles();
+    g_governor.sliceWorkerCyclesStart = g_workerCycles.load();
+    g_governor.sliceBytes = 0;
+}
+
+// Cooperative yield point; call after each unit of scan work.
+static void GovernorYield(size_t bytes) {
+    g_governor.sliceBytes += bytes;
+    g_governor.bytesScanned += bytes;
+
+    auto now = std::chrono::steady_clock::now();
+    u64 wallMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(now - g_governor.sliceStart).count());
+    if (wallMs < ScanGovernor::kSliceMs) return;
+
+    double scanMs = CyclesToMs(ThreadCycles() - g_governor.sliceCyclesStart);
+    double cpuMs = scanMs + CyclesToMs(g_workerCycles.load() - g_governor.sliceWorkerCyclesStart);
+    if (scanMs > 0.0) {
+        double sample = static_cast<double>(g_governor.sliceBytes) / scanMs;
+        g_governor.bytesPerCpuMs = g_governor.bytesPerCpuMs == 0.0 ? sample : (g_governor.bytesPerCpuMs * 0.75 + sample * 0.25);
+    }
+
+    int budget = g_options.scanCpuBudgetPercent;
+    if (budget > 0 && budget < 100) {
+        u64 requiredWallMs = static_cast<u64>(cpuMs * 100.0 / budget);
+        if (requiredWallMs > wallMs) {
+            u64 sleepMs = requiredWallMs - wallMs;
+            Sleep(static_cast<DWORD>(sleepMs));
+            g_governor.throttledMs += sleepMs;
+            g_governor.yieldCount++;
+        }
+    }
+
+    g_governor.sliceStart = std::chrono::steady_clock::now();
+    g_governor.sliceCyclesStart = ThreadCycles();
+    g_governor.sliceWorkerCyclesStart = g_workerCycles.load();
+    g_governor.sliceBytes = 0;
+}
+
+// Bytes of scan work to do before the next yield point.
+static size_t GovernorChunkSize(size_t baseChunk) {
+    if (g_options.scanCpuBudgetPercent >= 100 || g_governor.bytesPerCpuMs == 0.0) return baseChunk;
+
+    double target = g_governor.bytesPerCpuMs * ScanGovernor::kChunkTargetMs;
+    size_t chunk = static_cast<size_t>(target) & ~static_cast<size_t>(0xFFF);
+    return (std::min)((std::max)(chunk, ScanGovernor::kMinChunk), ScanGovernor::kMaxChunk);
+}
+
+static void GovernorReport(std::ostream& summary) {
+    u64 totalMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - g_governor.runStart).count());
+    u64 throttledMs = g_governor.throttledMs.load();
+    double deferredMB = g_governor.bytesPerCpuMs * static_cast<double>(throttledMs) / (1024.0 * 1024.0);
+    double throttledPercent = totalMs ? 100.0 * static_cast<double>(throttledMs) / static_cast<double>(totalMs) : 0.0;
+
+    LogLine("[GOVERNOR] Budget %d%%: throttled %llu of %llu ms (%.1f%%), ~%.1f MB of scan throughput given up",
+        g_options.scanCpuBudgetPercent, static_cast<unsigned long long>(throttledMs),
+        static_cast<unsigned long long>(totalMs), throttledPercent, deferredMB);
+
+    summary << "Scan Governor: budget " << g_options.scanCpuBudgetPercent << "%, throttled "
+        << throttledMs << " of " << totalMs << " ms, ~" << static_cast<u64>(deferredMB)
+        << " MB of throughput given up" << std::endl;
+}
+
+static void MemoryReport(std::ostream& summary) {
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+    u64 workingSetMB = GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+        ? static_cast<u64>(counters.PeakWorkingSetSize) / (1024 * 1024) : 0;
+    u64 arenaPeakKB = g_arenaPeakBytes.load() / 1024;
+    u64 retainedMB = g_retainedBytes.load() / (1024 * 1024);
+
+    LogLine("[MEMORY] Arena peak %llu KB, retained ~%llu MB (budget %d MB), game peak working set %llu MB",
+        static_cast<unsigned long long>(arenaPeakKB), static_cast<unsigned long long>(retainedMB),
+        g_options.memoryBudgetMB, static_cast<unsigned long long>(workingSetMB));
+
+    summary << "Dumper Memory: arena peak " << arenaPeakKB << " KB, retained ~" << retainedMB
+        << " MB of " << g_options.memoryBudgetMB << " MB budget"
+        << (MemoryBudgetExceeded() ? " (budget reached)" : "")
+        << ", process peak working set " << workingSetMB << " MB" << std::endl;
+}
+
+// Every string found by the string pass. Kept in arena blocks so the
+// pointer sweep never finds our own copy of the addresses.
+struct StringSite {
+    uintptr_t address;
+    u32 length;
+};
+
+static ScanArena g_xrefArena;
+static ArenaChunkedVector<StringSite> g_stringSites{ g_xrefArena };
+// Identifier-shaped strings only: the possible targets of a class's name pointer.
+static ArenaChunkedVector<uintptr_t> g_nameSites{ g_xrefArena };
+static std::atomic<u64> g_xrefStringCount{ 0 };
+static std::atomic<u64> g_xrefPointerCount{ 0 };
+static std::atomic<u64> g_stringsRejected{ 0 };
+
+static StringScoreLimits StringLimitsFromOptions() {
+    StringScoreLimits limits;
+    limits.minScore = g_options.stringMinScore;
+    limits.maxPunctPercent = g_options.stringMaxPunctPercent;
+    limits.maxRepeatPercent = g_options.stringMaxRepeatPercent;
+    limits.minEntropyTenths = g_options.stringMinEntropyTenths;
+    limits.maxEntropyTenths = g_options.stringMaxEntropyTenths;
+    return limits;
+}
+
+// Reads the next window of a region on a helper thread while the scan
+// thread classifies the current one. One read is in flight at a time. With
+// a CPU budget below 100% reads stay on the scan thread so the governor
+// still sees their cost.
+struct WindowPrefetcher {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread worker;
+    const void* address = nullptr;
+    void* target = nullptr;
+    size_t size = 0;
+    bool async = false;
+    bool requested = false;
+    bool ready = false;
+    bool result = false;
+    bool quit = false;
+
+    void Start(bool background) {
+        async = background;
+        if (async) worker = std::thread([this] { Run(); });
+    }
+
+    void Stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            quit = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    void Request(const void* from, void* to, size_t bytes) {
+        if (!async) {
+            result = FastReadMemory(GetCurrentProcess(), from, to, bytes);
+            ready = true;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            address = from;
+            target = to;
+            size = bytes;
+            requested = true;
+            ready = false;
+        }
+        cv.notify_all();
+    }
+
+    bool Wait() {
+        std::unique_lock<std::mutex> lock(mtx, std::defer_lock);
+        if (async) {
+            lock.lock();
+            cv.wait(lock, [this] { return ready; });
+        }
+        ready = false;
+        return result;
+    }
+
+    void Run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;) {
+            cv.wait(lock, [this] { return requested || quit; });
+            if (quit) return;
+            requested = false;
+            const void* from = address;
+            void* to = target;
+            size_t bytes = size;
+            lock.unlock();
+            bool ok = FastReadMemory(GetCurrentProcess(), from, to, bytes);
+            lock.lock();
+            result = ok;
+            ready = true;
+            cv.notify_all();
+        }
+    }
+};
+
+static constexpr size_t kStringMaxLength = 500;
+static constexpr size_t kStringWindow = 256 * 1024;
+// Room in front of each window for a run carried over from the previous one.
+static constexpr size_t kStringCarryRoom = 512;
+
+// Everything the string pass does with one accepted run: retention, xref and
+// name sites, relations and the string dumps.
+static void RecordExtractedString(std::string_view str, void* stringAddr, const StringFeatures& features) {
+    g_stringCount++;
+
+    if (!MemoryBudgetExceeded()) {
+        g_retainedBytes += sizeof(std::string) + str.size();
+        g_allStrings.Append(std::string(str));
+    }
+
+    if (g_options.enableStringXrefs && !MemoryBudgetExceeded()) {
+        g_stringSites.push_back({ reinterpret_cast<uintptr_t>(stringAddr), static_cast<u32>(str.size()) });
+    }
+
+    if (g_options.enableNameJoinDiscovery && str.size() <= 100 && features.space == 0 &&
+        features.Other() == 0 && !MemoryBudgetExceeded()) {
+        g_nameSites.push_back(reinterpret_cast<uintptr_t>(stringAddr));
+    }
+
+    AnalyzeStringRelations(str, stringAddr);
+
+    bool isImportant = false;
+    bool isRelated = false;
+
+    for (const auto& targetName : g_targetClassNames) {
+        if (str.find(targetName) != std::string_view::npos) {
+            isImportant = true;
+            isRelated = true;
+            break;
+        }
+    }
+
+    for (const auto& methodName : g_targetMethodNames) {
+        if (str.find(methodName) != std::string_view::npos) {
+            isImportant = true;
+            isRelated = true;
+            break;
+        }
+    }
 
-    {
-        std::lock_guard<std::mutex> lock(g_dataMutex);
-        g_allClasses.push_back(classInfo);
+    if (str.find("position") != std::string_view::npos ||
+        str.find("Position") != std::string_view::npos ||
+        str.find("damage") != std::string_view::npos ||
+        str.find("Damage") != std::string_view::npos ||
+        str.find("health") != std::string_view::npos ||
+        str.find("Health") != std::string_view::npos ||
+        str.find("Transform") != std::string_view::npos ||
+        str.find("Entity") != std::string_view::npos ||
+        str.find("Avatar") != std::string_view::npos ||
+        str.find("Player") != std::string_view::npos ||
+        str.find("Monster") != std::string_view::npos) {
+        isImportant = true;
+    }
 
-        if (classInfo.isTargetClass) {
-            g_targetClasses[classInfo.fullName] = classInfo;
-        }
+    LineBuffer stringEntry;
+    stringEntry << "[STRING] @ " << Hex(stringAddr) << ": \"" << str << '"';
 
-        g_classCount++;
+    if (g_options.enableAllStringDump) {
+        WriteFileImmediately("Kitay_Kazik_all_strings.txt", stringEntry.View());
     }
 
-    if (g_options.enableRealTimeOutput &&
-        ((g_options.enableTotalDump) ||
-            (g_options.enableImportantDump && (isTarget || classInfo.hasPositionData || classInfo.hasDamageData)))) {
+    if (g_options.enableRelatedStringsOnly && isRelated) {
+        WriteFileImmediately("Kitay_Kazik_related_strings.txt", stringEntry.View());
+    }
 
-        std::ostringstream classOutput;
-        classOutput << "[CLASS " << classNumber << "] " << classInfo.fullName << " @ 0x" << std::hex << classPtr << std::endl;
-        classOutput << "  Target: " << (classInfo.isTargetClass ? "YES" : "NO")
-            << " | Position: " << (classInfo.hasPositionData ? "YES" : "NO")
-            << " | Damage: " << (classInfo.hasDamageData ? "YES" : "NO") << std::endl;
+    if (g_options.enableImportantStringsOnly && isImportant) {
+        WriteFileImmediately("Kitay_Kazik_important_strings.txt", stringEntry.View());
+        LogLine("[IMPORTANT STRING] @ 0x%p: \"%.*s\"", stringAddr, static_cast<int>(str.size()), str.data());
+    }
+}
 
-        if (g_options.enableTotalDump || isTarget) {
-            classOutput << "  Fields (" << classInfo.fields.size() << "):" << std::endl;
-            for (const auto& field : classInfo.fields) {
-                classOutput << "    " << field << std::endl;
-            }
-            classOutput << "  Methods (" << classInfo.methods.size() << "):" << std::endl;
-            for (const auto& method : classInfo.methods) {
-                classOutput << "    " << method << std::endl;
-            }
+// Classifies the printable runs in data[0, size), which was read from base.
+// A run still open at the end is not judged here when more data follows;
+// the return value is how many trailing bytes the caller moves in front of
+// the next window. Runs over kStringMaxLength are dropped whole, so only
+// kStringMaxLength + 1 bytes of one ever need carrying.
+static size_t ScanStringWindow(const u8* data, size_t size, uintptr_t base, bool more,
+    const StringScoreLimits& limits, int& accepted) {
+    auto printable = [](u8 c) { return c >= 32 && c <= 126; };
+
+    size_t i = 0;
+    while (i < size) {
+        if (!printable(data[i])) {
+            i++;
+            continue;
         }
 
-        if (g_options.enableStringRelation && !classInfo.relatedStrings.empty()) {
-            classOutput << "  Related Strings (" << classInfo.relatedStrings.size() << "):" << std::endl;
-            for (const auto& str : classInfo.relatedStrings) {
-                classOutput << "    " << str << std::endl;
-            }
-        }
+        size_t end = i;
+        while (end < size && printable(data[end])) end++;
+        size_t strLen = end - i;
 
-        classOutput << std::endl;
+        if (end == size) {
+            return more ? (std::min)(strLen, kStringMaxLength + 1) : 0;
+        }
 
-        if (g_options.enableFileGrouping) {
-            if (g_options.enableTotalDump) {
-                WriteFileImmediately("Kitay_Kazik_total_dump.txt", classOutput.str());
+        if (data[end] == 0 && strLen >= 3 && strLen <= kStringMaxLength) {
+            std::string_view str(reinterpret_cast<const char*>(data + i), strLen);
+            StringFeatures features;
+            if (g_options.enableStringFilter || g_options.enableNameJoinDiscovery) {
+                features = MeasureString(str.data(), str.size());
             }
-            if (g_options.enableImportantDump && (isTarget || classInfo.hasPositionData || classInfo.hasDamageData)) {
-                WriteFileImmediately("Kitay_Kazik_important_dump.txt", classOutput.str());
+            if (g_options.enableStringFilter && ScoreString(features, limits) < limits.minScore) {
+                g_stringsRejected++;
+            }
+            else {
+                accepted++;
+                RecordExtractedString(str, reinterpret_cast<void*>(base + i), features);
             }
         }
-        else {
-            WriteFileImmediately("Kitay_Kazik_complete_analysis.txt", classOutput.str());
-        }
+
+        i = end + 1;
     }
+    return 0;
 }
 
 static void ExtractStringsWithOptions() {
@@ -763,6 +2728,8 @@ static void ExtractStringsWithOptions() {
     void* address = nullptr;
     MEMORY_BASIC_INFORMATION mbi;
     int totalStrings = 0;
+    u64 carriedRuns = 0;
+    const StringScoreLimits limits = StringLimitsFromOptions();
 
     if (g_options.enableFileGrouping) {
         if (g_options.enableAllStringDump) {
@@ -776,112 +2743,75 @@ static void ExtractStringsWithOptions() {
         }
     }
 
+    WindowPrefetcher prefetcher;
+    prefetcher.Start(g_options.scanCpuBudgetPercent >= 100);
+
     while (VirtualQueryEx(hProcess, address, &mbi, sizeof(mbi)) == sizeof(mbi)) {
         if (mbi.State == MEM_COMMIT &&
-            (mbi.Protect & (PAGE_READONLY | PAGE_READWRITE))) {
-
-            const size_t chunkSize = 64 * 1024;
-
-            for (size_t offset = 0; offset < mbi.RegionSize; offset += chunkSize) {
-                void* chunkAddr = static_cast<u8*>(mbi.BaseAddress) + offset;
-                size_t chunkSizeActual = (chunkSize < (mbi.RegionSize - offset)) ?
-                    chunkSize : (mbi.RegionSize - offset);
-
-                std::vector<u8> buffer(chunkSizeActual);
-                if (FastReadMemory(hProcess, chunkAddr, buffer.data(), chunkSizeActual)) {
-
-                    for (size_t i = 0; i < chunkSizeActual - 3; i++) {
-                        if (buffer[i] >= 32 && buffer[i] <= 126) {
-                            size_t strLen = 0;
-
-                            for (size_t j = i; j < chunkSizeActual && j < i + 500; j++) {
-                                if (buffer[j] == 0) {
-                                    strLen = j - i;
-                                    break;
-                                }
-                                if (buffer[j] < 32 || buffer[j] > 126) {
-                                    break;
-                                }
-                            }
-
-                            if (strLen >= 3 && strLen <= 500) {
-                                std::string str(reinterpret_cast<char*>(buffer.data() + i), strLen);
-                                totalStrings++;
-                                g_stringCount++;
-
-                                {
-                                    std::lock_guard<std::mutex> lock(g_dataMutex);
-                                    g_allStrings.push_back(str);
-                                }
-
-                                void* stringAddr = static_cast<u8*>(chunkAddr) + i;
-
-                                AnalyzeStringRelations(str, stringAddr);
-
-                                bool isImportant = false;
-                                bool isRelated = false;
-
-                                for (const auto& targetName : g_targetClassNames) {
-                                    if (str.find(targetName) != std::string::npos) {
-                                        isImportant = true;
-                                        isRelated = true;
-                                        break;
-                                    }
-                                }
-
-                                for (const auto& methodName : g_targetMethodNames) {
-                                    if (str.find(methodName) != std::string::npos) {
-                                        isImportant = true;
-                                        isRelated = true;
-                                        break;
-                                    }
-                                }
-
-                                if (str.find("position") != std::string::npos ||
-                                    str.find("Position") != std::string::npos ||
-                                    str.find("damage") != std::string::npos ||
-                                    str.find("Damage") != std::string::npos ||
-                                    str.find("health") != std::string::npos ||
-                                    str.find("Health") != std::string::npos ||
-                                    str.find("Transform") != std::string::npos ||
-                                    str.find("Entity") != std::string::npos ||
-                                    str.find("Avatar") != std::string::npos ||
-                                    str.find("Player") != std::string::npos ||
-                                    str.find("Monster") != std::string::npos) {
-                                    isImportant = true;
-                                }
-
-                                std::ostringstream stringEntry;
-                                stringEntry << "[STRING] @ 0x" << std::hex << stringAddr
-                                    << ": \"" << str << "\"";
-
-                                if (g_options.enableAllStringDump) {
-                                    WriteFileImmediately("Kitay_Kazik_all_strings.txt", stringEntry.str());
-                                }
-
-                                if (g_options.enableRelatedStringsOnly && isRelated) {
-                                    WriteFileImmediately("Kitay_Kazik_related_strings.txt", stringEntry.str());
-                                }
+            (mbi.Protect & (PAGE_READONLY | PAGE_READWRITE)) &&
+            !IsDumperRegion(mbi.AllocationBase)) {
+
+            // Two windows per region, each with carry room in front; while one
+            // is classified the prefetcher fills the other.
+            ArenaScope regionScope(PhaseArena());
+            u8* buffers[2];
+            for (auto& buffer : buffers) {
+                buffer = static_cast<u8*>(regionScope.arena.Allocate(kStringCarryRoom + ScanGovernor::kMaxChunk, 16)) + kStringCarryRoom;
+            }
 
-                                if (g_options.enableImportantStringsOnly && isImportant) {
-                                    WriteFileImmediately("Kitay_Kazik_important_strings.txt", stringEntry.str());
-                                    LogLine("[IMPORTANT STRING] @ 0x%p: \"%s\"", stringAddr, str.c_str());
-                                }
+            uintptr_t regionBase = reinterpret_cast<uintptr_t>(mbi.BaseAddress);
+            size_t offset = 0;
+            size_t windowSize = (std::min)(GovernorChunkSize(kStringWindow), mbi.RegionSize);
+            size_t carry = 0;
+            int current = 0;
+            prefetcher.Request(mbi.BaseAddress, buffers[current], windowSize);
+
+            while (windowSize > 0) {
+                bool ok = prefetcher.Wait();
+
+                size_t nextOffset = offset + windowSize;
+                size_t nextSize = nextOffset < mbi.RegionSize ?
+                    (std::min)(GovernorChunkSize(kStringWindow), mbi.RegionSize - nextOffset) : 0;
+                if (nextSize > 0) {
+                    prefetcher.Request(reinterpret_cast<void*>(regionBase + nextOffset), buffers[current ^ 1], nextSize);
+                }
 
-                                i += strLen;
-                            }
-                        }
+                if (ok) {
+                    u8* window = buffers[current];
+                    carry = ScanStringWindow(window - carry, carry + windowSize, regionBase + offset - carry,
+                        nextSize > 0, limits, totalStrings);
+                    if (carry > 0) {
+                        // The prefetch writes from buffers[next] onward, the carry
+                        // lands in the room just before it.
+                        std::memcpy(buffers[current ^ 1] - carry, window + windowSize - carry, carry);
+                        carriedRuns++;
                     }
                 }
+                else {
+                    carry = 0;
+                }
+
+                GovernorYield(windowSize);
+                offset = nextOffset;
+                windowSize = nextSize;
+                current ^= 1;
             }
         }
 
         address = static_cast<u8*>(mbi.BaseAddress) + mbi.RegionSize;
     }
 
-    LogLine("[STRINGS] Found %d total strings", totalStrings);
+    prefetcher.Stop();
+
+    LogLine("[STRINGS] Found %d total strings (%llu runs carried across windows)", totalStrings,
+        static_cast<unsigned long long>(carriedRuns));
+    if (g_options.enableStringFilter) {
+        LogLine("[STRINGS] Filter dropped %llu low-quality runs (score < %d)",
+            static_cast<unsigned long long>(g_stringsRejected.load()), limits.minScore);
+    }
 }
 
+template <typename Layout>
 static void ClassDiscoveryWithOptions() {
     LogLine("[DISCOVERY] Starting class discovery with options");
     DisplayCurrentOptions();
@@ -894,7 +2824,8 @@ static void ClassDiscoveryWithOptions() {
 
     while (VirtualQueryEx(hProcess, address, &mbi, sizeof(mbi)) == sizeof(mbi)) {
         if (mbi.State == MEM_COMMIT &&
-            (mbi.Protect & (PAGE_READONLY | PAGE_READWRITE))) {
+            (mbi.Protect & (PAGE_READONLY | PAGE_READWRITE)) &&
+            !IsDumperRegion(mbi.AllocationBase)) {
 
             regionCount++;
 
@@ -902,12 +2833,20 @@ static void ClassDiscoveryWithOptions() {
                 regionCount, mbi.BaseAddress, mbi.RegionSize / 1024);
 
             int regionClasses = 0;
+            size_t yieldAt = GovernorChunkSize(64 * 1024);
+            size_t lastYield = 0;
 
             for (size_t offset = 0; offset < mbi.RegionSize - 0x200; offset += 8) {
                 void* candidate = static_cast<u8*>(mbi.BaseAddress) + offset;
 
+                if (offset - lastYield >= yieldAt) {
+                    GovernorYield(offset - lastYield);
+                    lastYield = offset;
+                    yieldAt = GovernorChunkSize(64 * 1024);
+                }
+
                 void* namePtr = nullptr;
-                if (FastReadPointer(hProcess, candidate, kNameOff, &namePtr) && namePtr) {
+                if (FastReadPointer(hProcess, candidate, Layout::kNameOff, &namePtr) && namePtr) {
 
                     std::string name;
                     if (FastReadString(hProcess, namePtr, name, 100) && name.length() > 1) {
@@ -923,7 +2862,7 @@ static void ClassDiscoveryWithOptions() {
                             regionClasses++;
                             totalClasses++;
 
-                            AnalyzeClassWithOptions(hProcess, candidate, totalClasses);
+                            AnalyzeClassWithOptions<Layout>(hProcess, candidate, totalClasses);
 
                             if (totalClasses % 100 == 0 && g_options.enableVectorTracking) {
                                 MonitorVectorChanges();
@@ -951,6 +2890,554 @@ static void ClassDiscoveryWithOptions() {
         totalClasses, g_targetClassCount.load());
 }
 
+// Signed 64-bit a > b per lane with SSE2 only: the high dwords decide
+// unless they are equal, in which case the borrow of b - a does.
+static inline __m128i CompareGreater64(__m128i a, __m128i b) {
+    __m128i r = _mm_and_si128(_mm_cmpeq_epi32(a, b), _mm_sub_epi64(b, a));
+    r = _mm_or_si128(r, _mm_cmpgt_epi32(a, b));
+    return _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+// Sorted target addresses for the pointer sweeps. A candidate word is
+// range-checked against the whole set, then tested against a bit filter
+// with about 16 bits per target, and only then binary-searched. Storage
+// lives in the caller's arena.
+struct PointerTargetSet {
+    static constexpr int kMinFilterBits = 16;
+    static constexpr int kMaxFilterBits = 27;
+    static constexpr u64 kSignBias = 0x8000000000000000ull;
+
+    ArenaVector<uintptr_t> sorted;
+    ArenaVector<u64> filter;
+    int filterShift = 64 - kMinFilterBits;
+    uintptr_t lo = 0;
+    uintptr_t span = 0;
+    __m128i vecLo = _mm_setzero_si128();
+    __m128i vecLimit = _mm_setzero_si128();
+
+    explicit PointerTargetSet(ScanArena& arena)
+        : sorted(ArenaAllocator<uintptr_t>(arena)), filter(ArenaAllocator<u64>(arena)) {}
+
+    size_t FilterSlot(uintptr_t value) const {
+        return static_cast<size_t>((static_cast<u64>(value) * 0x9E3779B97F4A7C15ull) >> filterShift);
+    }
+
+    // sorted must already be in ascending order. One bit in 16 set keeps
+    // false positives near 6% however many targets there are.
+    void Build() {
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        int filterBits = kMinFilterBits;
+        while (filterBits < kMaxFilterBits && (size_t(1) << filterBits) < sorted.size() * 16) filterBits++;
+        filterShift = 64 - filterBits;
+        filter.assign((size_t(1) << filterBits) / 64, 0);
+        for (uintptr_t value : sorted) {
+            size_t slot = FilterSlot(value);
+            filter[slot / 64] |= 1ull << (slot % 64);
+        }
+        lo = sorted.empty() ? 0 : sorted.front();
+        span = sorted.empty() ? 0 : sorted.back() - lo;
+        vecLo = _mm_set1_epi64x(static_cast<long long>(lo));
+        vecLimit = _mm_set1_epi64x(static_cast<long long>(static_cast<u64>(span) ^ kSignBias));
+    }
+
+    bool InRange(uintptr_t value) const {
+        return value - lo <= span;
+    }
+
+    // InRange for words[0..3] at once. value - lo <= span is an unsigned
+    // compare, done signed after flipping the sign bit of both sides.
+    bool AnyInRange4(const uintptr_t* words) const {
+        if constexpr (sizeof(uintptr_t) == 8) {
+            const __m128i bias = _mm_set1_epi64x(static_cast<long long>(kSignBias));
+            __m128i a = _mm_xor_si128(_mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words)), vecLo), bias);
+            __m128i b = _mm_xor_si128(_mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + 2)), vecLo), bias);
+            __m128i outside = _mm_and_si128(CompareGreater64(a, vecLimit), CompareGreater64(b, vecLimit));
+            return _mm_movemask_epi8(outside) != 0xFFFF;
+        } else {
+            return InRange(words[0]) | InRange(words[1]) | InRange(words[2]) | InRange(words[3]);
+        }
+    }
+
+    ptrdiff_t Find(uintptr_t value) const {
+        size_t slot = FilterSlot(value);
+        if (!(filter[slot / 64] & (1ull << (slot % 64)))) return -1;
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), value);
+        return it != sorted.end() && *it == value ? it - sorted.begin() : -1;
+    }
+};
+
+// One linear pass over readable memory; fn(referrer, targetIndex, nextWord)
+// runs for every 8-byte aligned word equal to a target. nextWord points at
+// the word after it, read across chunk and region ends, or is null when
+// that word is unreadable. Words are range-checked four at a
+// time in two SSE2 registers, so a block with no candidates costs a few
+// vector ops per four words.
+template <typename Fn>
+static u64 SweepPointers(const PointerTargetSet& targets, bool heapOnly, Fn&& fn) {
+    if (targets.sorted.empty()) return 0;
+
+    HANDLE hProcess = GetCurrentProcess();
+    void* address = nullptr;
+    MEMORY_BASIC_INFORMATION mbi;
+    u64 scanned = 0;
+
+    while (VirtualQueryEx(hProcess, address, &mbi, sizeof(mbi)) == sizeof(mbi)) {
+        bool readable = heapOnly
+            ? (mbi.Type == MEM_PRIVATE && (mbi.Protect & PAGE_READWRITE))
+            : (mbi.Protect & (PAGE_READONLY | PAGE_READWRITE)) != 0;
+
+        if (mbi.State == MEM_COMMIT && readable && !(mbi.Protect & PAGE_GUARD) &&
+            !IsDumperRegion(mbi.AllocationBase)) {
+
+            ArenaScope regionScope(PhaseArena());
+            u8* buffer = static_cast<u8*>(regionScope.arena.Allocate(ScanGovernor::kMaxChunk, 16));
+            size_t chunkSize = 0;
+
+            for (size_t offset = 0; offset < mbi.RegionSize; offset += chunkSize) {
+                chunkSize = (std::min)(GovernorChunkSize(256 * 1024), mbi.RegionSize - offset);
+                uintptr_t chunkAddr = reinterpret_cast<uintptr_t>(mbi.BaseAddress) + offset;
+
+                if (FastReadMemory(hProcess, reinterpret_cast<const void*>(chunkAddr), buffer, chunkSize)) {
+                    const uintptr_t* words = reinterpret_cast<const uintptr_t*>(buffer);
+                    size_t count = chunkSize / sizeof(uintptr_t);
+
+                    auto check = [&](size_t index) {
+                        if (!targets.InRange(words[index])) return;
+                        ptrdiff_t target = targets.Find(words[index]);
+                        if (target < 0) return;
+                        uintptr_t referrer = chunkAddr + index * sizeof(uintptr_t);
+                        uintptr_t following = 0;
+                        const uintptr_t* nextWord = &following;
+                        if (index + 1 < count) {
+                            nextWord = &words[index + 1];
+                        }
+                        else if (!FastReadMemory(hProcess, reinterpret_cast<const void*>(referrer + sizeof(uintptr_t)),
+                            &following, sizeof(following))) {
+                            nextWord = nullptr;
+                        }
+                        fn(referrer, static_cast<size_t>(target), nextWord);
+                    };
+
+                    size_t i = 0;
+                    for (; i + 4 <= count; i += 4) {
+                        if (!targets.AnyInRange4(words + i)) continue;
+                        for (size_t j = i; j < i + 4; j++) check(j);
+                    }
+                    for (; i < count; i++) check(i);
+                }
+
+                scanned += chunkSize;
+                GovernorYield(chunkSize);
+            }
+        }
+
+        address = static_cast<u8*>(mbi.BaseAddress) + mbi.RegionSize;
+    }
+
+    return scanned;
+}
+
+// Discovery by join instead of by guess: one sweep finds every aligned word
+// that points at an identifier-shaped string, and each hit minus kNameOff is
+// a class candidate. When kNsOff follows kNameOff, the word after the hit
+// must be a namespace pointer: null, another name site, or an empty string.
+template <typename Layout>
+static bool NameJoinDiscovery() {
+    if (!g_options.enableNameJoinDiscovery) return false;
+    if (g_nameSites.empty()) {
+        LogLine("[JOIN] No identifier strings collected, falling back to offset scan");
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    LogLine("[JOIN] Sweeping for pointers to %zu identifier strings...", g_nameSites.size());
+
+    HANDLE hProcess = GetCurrentProcess();
+    ArenaScope passScope(g_xrefArena);
+    std::sort(g_nameSites.begin(), g_nameSites.end());
+
+    PointerTargetSet targets(g_xrefArena);
+    targets.sorted.assign(g_nameSites.begin(), g_nameSites.end());
+    targets.Build();
+
+    auto isNamespace = [&](uintptr_t word) {
+        if (!word) return true;
+        if (targets.InRange(word) && targets.Find(word) >= 0) return true;
+        char first = 1;
+        return FastReadMemory(hProcess, reinterpret_cast<const void*>(word), &first, 1) && first == 0;
+    };
+
+    ArenaVector<uintptr_t> candidates{ ArenaAllocator<uintptr_t>(g_xrefArena) };
+    u64 hits = 0;
+    u64 scanned = SweepPointers(targets, false, [&](uintptr_t referrer, size_t, const uintptr_t* nextWord) {
+        hits++;
+        if (referrer < static_cast<uintptr_t>(Layout::kNameOff)) return;
+        if (Layout::kNsFollowsName && (!nextWord || !isNamespace(*nextWord))) return;
+        candidates.push_back(referrer - Layout::kNameOff);
+    });
+
+    int totalClasses = 0;
+    for (uintptr_t candidate : candidates) {
+        totalClasses++;
+        AnalyzeClassWithOptions<Layout>(hProcess, reinterpret_cast<void*>(candidate), totalClasses);
+
+        if (totalClasses % 100 == 0 && g_options.enableVectorTracking) {
+            MonitorVectorChanges();
+        }
+
+        if (totalClasses % 1000 == 0) {
+            LogLine("=== PROGRESS: %d classes analyzed ===", totalClasses);
+            if (g_options.enableConsoleMonitoring) {
+                UpdateConsoleDisplay();
+            }
+        }
+    }
+
+    u64 elapsedMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    LogLine("[JOIN] %llu name pointers, %zu class candidates, %llu MB swept in %llu ms",
+        static_cast<unsigned long long>(hits), candidates.size(),
+        static_cast<unsigned long long>(scanned / (1024 * 1024)), static_cast<unsigned long long>(elapsedMs));
+    LogLine("[DISCOVERY] COMPLETE! Total classes: %d, Target classes: %d",
+        totalClasses, g_targetClassCount.load());
+    return true;
+}
+
+// Builds the string -> referrer index from one pointer sweep, writes it out
+// and attaches the referrers that sit inside a discovered class to that
+// class's relatedStrings.
+template <typename Layout>
+static void StringXrefPass() {
+    if (!g_options.enableStringXrefs || g_stringSites.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+    LogLine("[XREF] Sweeping for pointers to %zu strings...", g_stringSites.size());
+
+    ArenaScope passScope(g_xrefArena);
+    auto byAddress = [](const StringSite& a, const StringSite& b) { return a.address < b.address; };
+    if (!std::is_sorted(g_stringSites.begin(), g_stringSites.end(), byAddress)) {
+        std::sort(g_stringSites.begin(), g_stringSites.end(), byAddress);
+    }
+    g_stringSites.Truncate(static_cast<size_t>(std::unique(g_stringSites.begin(), g_stringSites.end(),
+        [](const StringSite& a, const StringSite& b) { return a.address == b.address; }) - g_stringSites.begin()));
+
+    PointerTargetSet targets(g_xrefArena);
+    targets.sorted.reserve(g_stringSites.size());
+    for (const auto& site : g_stringSites) {
+        targets.sorted.push_back(site.address);
+    }
+    targets.Build();
+
+    // (string index, referrer)
+    ArenaVector<std::pair<u32, uintptr_t>> refs{ ArenaAllocator<std::pair<u32, uintptr_t>>(g_xrefArena) };
+    u64 scanned = SweepPointers(targets, false, [&](uintptr_t referrer, size_t target, const uintptr_t*) {
+        g_xrefPointerCount++;
+        if (MemoryBudgetExceeded()) return;
+        refs.emplace_back(static_cast<u32>(target), referrer);
+        g_retainedBytes += sizeof(refs[0]);
+    });
+    std::sort(refs.begin(), refs.end());
+
+    HANDLE hProcess = GetCurrentProcess();
+    // Sites were measured during extraction, so exactly site.length bytes
+    // are copied; no terminator is looked for.
+    auto readSite = [&](u32 index) {
+        const StringSite& site = g_stringSites[index];
+        char text[kStringMaxLength];
+        size_t length = (std::min)(static_cast<size_t>(site.length), sizeof(text));
+        if (!FastReadMemory(hProcess, reinterpret_cast<const void*>(site.address), text, length)) return std::string();
+        return std::string(text, length);
+    };
+
+    std::ofstream xrefFile(TempPath("Kitay_Kazik_string_xrefs.txt"));
+    for (size_t i = 0; i < refs.size();) {
+        size_t end = i;
+        while (end < refs.size() && refs[end].first == refs[i].first) end++;
+        g_xrefStringCount++;
+
+        LineBuffer line;
+        line << Hex(g_stringSites[refs[i].first].address) << " \"" << readSite(refs[i].first) << "\" <- " << (end - i) << ':';
+        for (size_t j = i; j < end && j < i + 16; j++) {
+            line << ' ' << Hex(refs[j].second);
+        }
+        if (end - i > 16) line << " (+" << (end - i - 16) << " more)";
+        line << '\n';
+        xrefFile.write(line.data, static_cast<std::streamsize>(line.size));
+        i = end;
+    }
+
+    // A referrer inside the first 0x100 bytes of a class is one of its
+    // metadata pointers; the class's own name and namespace are skipped.
+    ArenaVector<std::pair<uintptr_t, u32>> byReferrer{ ArenaAllocator<std::pair<uintptr_t, u32>>(g_xrefArena) };
+    byReferrer.reserve(refs.size());
+    for (const auto& ref : refs) {
+        byReferrer.emplace_back(ref.second, ref.first);
+    }
+    std::sort(byReferrer.begin(), byReferrer.end());
+
+    g_allClasses.ForEach([&](ClassInfo& classInfo) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(classInfo.address);
+        if (!base) return;
+        auto it = std::lower_bound(byReferrer.begin(), byReferrer.end(), std::make_pair(base, 0u));
+        for (; it != byReferrer.end() && it->first < base + 0x100; ++it) {
+            uintptr_t fieldOffset = it->first - base;
+            if (fieldOffset == static_cast<uintptr_t>(Layout::kNameOff) || fieldOffset == static_cast<uintptr_t>(Layout::kNsOff)) continue;
+            classInfo.relatedStrings.push_back(readSite(it->second) + " @ " +
+                HexName("", reinterpret_cast<void*>(g_stringSites[it->second].address)) +
+                " [xref " + HexName("+", reinterpret_cast<void*>(fieldOffset)) + "]");
+        }
+    });
+
+    u64 elapsedMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    LogLine("[XREF] %llu strings referenced by %llu pointers (%llu MB swept in %llu ms)",
+        static_cast<unsigned long long>(g_xrefStringCount.load()),
+        static_cast<unsigned long long>(g_xrefPointerCount.load()),
+        static_cast<unsigned long long>(scanned / (1024 * 1024)), static_cast<unsigned long long>(elapsedMs));
+}
+
+static constexpr size_t kCensusSummaryRows = 25;
+
+struct CensusRow {
+    u64 instances;
+    uintptr_t address;
+    std::string fullName;
+};
+
+static std::vector<CensusRow> g_censusRows;
+static u64 g_censusObjects = 0;
+
+// Addresses of the words where the dumper itself keeps a class pointer:
+// ClassInfo and FoundAddress copies, chain nodes, index records, important
+// entries and every snapshot of them still alive, and the previous census.
+// They sit in host heap the sweep reads like any other, so hits at these
+// referrers are not counted as instances. Arena memory is skipped by the
+// sweep itself.
+static void CollectSelfReferences(ArenaVector<uintptr_t>& out) {
+    auto add = [&](const void* slot) { out.push_back(reinterpret_cast<uintptr_t>(slot)); };
+    auto addClass = [&](const ClassInfo& classInfo) {
+        add(&classInfo.address);
+        for (const auto& found : classInfo.foundAddresses) add(&found.address);
+    };
+
+    g_allClasses.ForEach(addClass);
+    g_allFoundAddresses.ForEach([&](FoundAddress& found) { add(&found.address); });
+    g_indexRecords.ForEach([&](DumpIndexRecord& record) { add(&record.address); });
+    {
+        std::lock_guard<std::mutex> lock(g_dataMutex);
+        for (const auto& entry : g_targetClasses) addClass(entry.second);
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_classGraph.mtx);
+        for (const auto& entry : g_classGraph.nodes) {
+            add(&entry.first);
+            if (entry.second) add(&entry.second->address);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_importantMutex);
+        for (const auto& entry : g_importantEntries) add(&entry.address);
+        for (const auto& held : g_importantSnapshots) {
+            if (auto snapshot = held.lock()) {
+                for (const auto& entry : *snapshot) add(&entry.address);
+            }
+        }
+    }
+    for (const auto& row : g_censusRows) add(&row.address);
+
+    std::sort(out.begin(), out.end());
+}
+
+// Live-object census: an Il2CppObject starts with its klass pointer and a
+// monitor that is null unless the object is locked, so a heap word equal to
+// a discovered class followed by a null word is counted as one instance.
+// Stray copies of class pointers can still match, so counts are approximate.
+static void HeapCensusPass() {
+    if (!g_options.enableHeapCensus || g_allClasses.Size() == 0) return;
+
+    auto start = std::chrono::steady_clock::now();
+    LogLine("[CENSUS] Counting live objects of %zu classes...", g_allClasses.Size());
+
+    ArenaScope passScope(PhaseArena());
+    PointerTargetSet targets(passScope.arena);
+    targets.sorted.reserve(g_allClasses.Size());
+    g_allClasses.ForEach([&](ClassInfo& classInfo) {
+        if (classInfo.address) targets.sorted.push_back(reinterpret_cast<uintptr_t>(classInfo.address));
+    });
+    if (targets.sorted.empty()) {
+        LogLine("[CENSUS] No class has a live address (metadata catalog or 32-bit build), skipping");
+        return;
+    }
+    std::sort(targets.sorted.begin(), targets.sorted.end());
+    targets.Build();
+
+    ArenaVector<uintptr_t> selfReferences{ ArenaAllocator<uintptr_t>(passScope.arena) };
+    CollectSelfReferences(selfReferences);
+
+    std::vector<u64> counts(targets.sorted.size(), 0);
+    u64 selfHits = 0;
+    u64 scanned = SweepPointers(targets, true, [&](uintptr_t referrer, size_t target, const uintptr_t* monitor) {
+        if (!monitor || *monitor != 0) return;
+        if (std::binary_search(selfReferences.begin(), selfReferences.end(), referrer)) {
+            selfHits++;
+            return;
+        }
+        counts[target]++;
+    });
+
+    std::vector<std::string> names(targets.sorted.size());
+    g_allClasses.ForEach([&](ClassInfo& classInfo) {
+        ptrdiff_t index = targets.Find(reinterpret_cast<uintptr_t>(classInfo.address));
+        if (index >= 0) names[index] = classInfo.fullName;
+    });
+
+    g_censusRows.clear();
+    g_censusObjects = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] == 0) continue;
+        g_censusRows.push_back({ counts[i], targets.sorted[i], std::move(names[i]) });
+        g_censusObjects += counts[i];
+    }
+    std::sort(g_censusRows.begin(), g_censusRows.end(), [](const CensusRow& a, const CensusRow& b) {
+        return a.instances != b.instances ? a.instances > b.instances : a.fullName < b.fullName;
+    });
+
+    std::ofstream histogram(TempPath("Kitay_Kazik_class_histogram.txt"));
+    histogram << " num     #instances  class address       class name" << std::endl;
+    histogram << "----------------------------------------------------------" << std::endl;
+    for (size_t i = 0; i < g_censusRows.size(); i++) {
+        const CensusRow& row = g_censusRows[i];
+        histogram << std::setw(4) << (i + 1) << ": " << std::setw(14) << row.instances << "  "
+            << HexName("", reinterpret_cast<void*>(row.address)) << "  " << row.fullName << std::endl;
+    }
+    histogram << "Total " << std::setw(14) << g_censusObjects << std::endl;
+
+    u64 elapsedMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    LogLine("[CENSUS] %llu objects across %zu classes, %llu dumper copies skipped (%llu MB of heap swept in %llu ms)",
+        static_cast<unsigned long long>(g_censusObjects), g_censusRows.size(), static_cast<unsigned long long>(selfHits),
+        static_cast<unsigned long long>(scanned / (1024 * 1024)), static_cast<unsigned long long>(elapsedMs));
+}
+
+static constexpr size_t kSnapshotFrameSize = 1024 * 1024;
+static constexpr DWORD kSnapshotReadable = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY |
+    PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+static std::string RegionModuleName(const MEMORY_BASIC_INFORMATION& mbi) {
+    if (mbi.Type != MEM_IMAGE) return "-";
+
+    char path[MAX_PATH] = {};
+    if (!GetModuleFileNameA(static_cast<HMODULE>(mbi.AllocationBase), path, MAX_PATH)) return "?";
+    const char* slash = std::strrchr(path, '\\');
+    return slash ? slash + 1 : path;
+}
+
+static const char* RegionTypeName(DWORD type) {
+    switch (type) {
+    case MEM_IMAGE: return "IMAGE";
+    case MEM_MAPPED: return "MAPPED";
+    case MEM_PRIVATE: return "PRIVATE";
+    default: return "?";
+    }
+}
+
+// Raw capture: one pass over the committed readable regions, copied in
+// large reads and handed to the frame pipeline, with no string or class
+// analysis. The manifest maps every region to its offset in the decoded
+// snapshot stream so the analysis can run later against the file.
+static void CaptureSnapshot() {
+    LogLine("[SNAPSHOT] Capturing raw regions...");
+    auto start = std::chrono::steady_clock::now();
+
+    std::string snapshotPath = TempPath("Kitay_Kazik_snapshot.kzf");
+    std::remove(snapshotPath.c_str());
+
+    // Each worker holds one slot for its output; the rest carry input frames.
+    int workers = (std::max)(1, g_options.snapshotWorkers);
+    ArenaScope poolScope(PhaseArena());
+    FrameSlotPool pool;
+    pool.Init(poolScope.arena, FrameEncodedBound(kSnapshotFrameSize), static_cast<size_t>(workers) * 3 + 2);
+
+    FramePipeline pipeline;
+    pipeline.level = g_options.lz4Level;
+    pipeline.pool = &pool;
+    if (!FramePipelineOpen(pipeline, snapshotPath, workers)) {
+        LogLine("[SNAPSHOT] Failed to open %s", snapshotPath.c_str());
+        return;
+    }
+    GovernorBegin();
+
+    std::ostringstream manifest;
+    manifest << "# base size protect type offset missing module" << std::endl;
+
+    HANDLE hProcess = GetCurrentProcess();
+    void* address = nullptr;
+    MEMORY_BASIC_INFORMATION mbi;
+    u64 streamOffset = 0;
+    u64 missingTotal = 0;
+    int regionCount = 0;
+    void* lastAllocation = nullptr;
+    std::string moduleName;
+
+    while (VirtualQueryEx(hProcess, address, &mbi, sizeof(mbi)) == sizeof(mbi)) {
+        if (mbi.State == MEM_COMMIT && (mbi.Protect & kSnapshotReadable) &&
+            !(mbi.Protect & PAGE_GUARD) && !IsDumperRegion(mbi.AllocationBase)) {
+
+            if (mbi.AllocationBase != lastAllocation) {
+                lastAllocation = mbi.AllocationBase;
+                moduleName = RegionModuleName(mbi);
+            }
+
+            u64 regionOffset = streamOffset;
+            u64 missing = 0;
+            for (size_t offset = 0; offset < mbi.RegionSize; offset += kSnapshotFrameSize) {
+                size_t size = (std::min)(kSnapshotFrameSize, mbi.RegionSize - offset);
+                const u8* chunkAddr = static_cast<const u8*>(mbi.BaseAddress) + offset;
+                u8* frame = pool.Acquire();
+
+                if (!FastReadMemory(hProcess, chunkAddr, frame, size)) {
+                    // Pages can be decommitted under us; keep the stream
+                    // aligned with the manifest and zero what we lost.
+                    for (size_t page = 0; page < size; page += 0x1000) {
+                        size_t pageSize = (std::min)(static_cast<size_t>(0x1000), size - page);
+                        if (!FastReadMemory(hProcess, chunkAddr + page, frame + page, pageSize)) {
+                            std::memset(frame + page, 0, pageSize);
+                            missing += pageSize;
+                        }
+                    }
+                }
+
+                FramePipelineSubmitSlot(pipeline, frame, size);
+                GovernorYield(size);
+            }
+
+            streamOffset += mbi.RegionSize;
+            missingTotal += missing;
+            regionCount++;
+
+            LineBuffer line;
+            line << Hex(mbi.BaseAddress) << ' ' << Hex(mbi.RegionSize) << ' ' << Hex(mbi.Protect) << ' '
+                << RegionTypeName(mbi.Type) << ' ' << Hex(regionOffset) << ' ' << missing << ' ' << moduleName << '\n';
+            manifest.write(line.data, static_cast<std::streamsize>(line.size));
+        }
+
+        address = static_cast<u8*>(mbi.BaseAddress) + mbi.RegionSize;
+    }
+
+    FramePipelineClose(pipeline);
+
+    std::ofstream manifestFile(TempPath("Kitay_Kazik_snapshot_regions.txt"));
+    manifestFile << manifest.str();
+
+    u64 elapsedMs = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    double capturedMB = static_cast<double>(streamOffset) / (1024.0 * 1024.0);
+    LogLine("[SNAPSHOT] %d regions, %.1f MB -> %.1f MB in %llu ms (%.0f MB/s, %llu ms throttled), %llu bytes unreadable",
+        regionCount, capturedMB, static_cast<double>(pipeline.storedBytes.load()) / (1024.0 * 1024.0),
+        static_cast<unsigned long long>(elapsedMs), elapsedMs ? capturedMB * 1000.0 / elapsedMs : capturedMB,
+        static_cast<unsigned long long>(g_governor.throttledMs.load()), static_cast<unsigned long long>(missingTotal));
+}
+
 static void GenerateOptionsBasedReports() {
     LogLine("[OUTPUT] Generating reports based on enabled options...");
 
@@ -964,10 +3451,60 @@ static void GenerateOptionsBasedReports() {
             summaryFile << "Target Classes Found: " << g_targetClassCount.load() << std::endl;
             summaryFile << "Addresses Discovered: " << g_addressCount.load() << std::endl;
             summaryFile << "Total Strings: " << g_stringCount.load() << std::endl;
+            if (g_options.enableStringFilter) {
+                summaryFile << "Strings Filtered Out: " << g_stringsRejected.load()
+                    << " (score < " << g_options.stringMinScore << ")" << std::endl;
+            }
+
+            if (g_options.enableConnectionAnalysis) {
+                summaryFile << "Inheritance Edges: " << g_connectionCount.load() << std::endl;
+            }
+
+            if (g_options.enableGenericFolding) {
+                summaryFile << "Generic Folding: " << g_genericFolded.load() << " instances folded into "
+                    << g_genericFamilies.size() << " definitions (" << g_genericLinesSaved.load()
+                    << " member lines not repeated)" << std::endl;
+            }
+
+            if (g_options.enableStringXrefs) {
+                summaryFile << "String Xrefs: " << g_xrefStringCount.load() << " strings referenced by "
+                    << g_xrefPointerCount.load() << " pointers" << std::endl;
+            }
+
+            if (g_options.enableHeapCensus) {
+                summaryFile << "Heap Census: " << g_censusObjects << " live objects in "
+                    << g_censusRows.size() << " classes" << std::endl;
+                for (size_t i = 0; i < g_censusRows.size() && i < kCensusSummaryRows; i++) {
+                    summaryFile << "  " << std::setw(10) << g_censusRows[i].instances << "  "
+                        << g_censusRows[i].fullName << std::endl;
+                }
+            }
+
+            GovernorReport(summaryFile);
+            MemoryReport(summaryFile);
+
+            if (g_options.enableCompressedOutput) {
+                summaryFile << "Compressed Output: " << g_compressedRawBytes.load() << " raw bytes -> "
+                    << g_compressedStoredBytes.load() << " bytes written" << std::endl;
+            }
+
+            if (g_options.enableFieldTypes) {
+                summaryFile << "Distinct Field Types: " << g_typeNameCache.Size()
+                    << " (cache hits: " << g_typeNameCache.hits.load()
+                    << ", decodes: " << g_typeNameCache.misses.load() << ")" << std::endl;
+            }
+
+            {
+                u64 methodHits = g_methodCache.hits.load();
+                u64 methodLookups = methodHits + g_methodCache.misses.load();
+                summaryFile << "Distinct Methods: " << g_methodCache.Size()
+                    << " (cache hits: " << methodHits << ", decodes: " << g_methodCache.misses.load()
+                    << ", hit rate: " << (methodLookups ? methodHits * 100 / methodLookups : 0) << "%)" << std::endl;
+            }
 
             if (g_options.enableVectorTracking) {
                 summaryFile << "Vector Changes Detected: " << g_vectorChangeCount.load() << std::endl;
-                summaryFile << "Vectors Tracked: " << g_allTrackedVectors.size() << std::endl;
+                summaryFile << "Vectors Tracked: " << g_allTrackedVectors.Size() << std::endl;
             }
 
             summaryFile << std::endl << "ENABLED OPTIONS:" << std::endl;
@@ -979,7 +3516,12 @@ static void GenerateOptionsBasedReports() {
 
             summaryFile << std::endl << "FILES GENERATED:" << std::endl;
             if (g_options.enableTotalDump) {
-                summaryFile << "- Kitay_Kazik_total_dump.txt (Complete class dump)" << std::endl;
+                summaryFile << "- Kitay_Kazik_total_dump.txt" << (g_options.enableCompressedOutput ? ".kzf" : "")
+                    << " (Complete class dump)" << std::endl;
+            }
+            if (g_options.enableAllStringDump) {
+                summaryFile << "- Kitay_Kazik_all_strings.txt" << (g_options.enableCompressedOutput ? ".kzf" : "")
+                    << " (Every extracted string)" << std::endl;
             }
             if (g_options.enableImportantDump) {
                 summaryFile << "- Kitay_Kazik_important_dump.txt (Target classes and position/damage data)" << std::endl;
@@ -995,14 +3537,55 @@ static void GenerateOptionsBasedReports() {
                 summaryFile << "- Kitay_Kazik_addresses_Method.txt (Method addresses)" << std::endl;
                 summaryFile << "- Kitay_Kazik_addresses_Field.txt (Field addresses)" << std::endl;
             }
+            if (g_options.enableDumpIndex) {
+                summaryFile << "- Kitay_Kazik_dump_index.kzi (Class/method lookup index, see Tools/kazik_query)" << std::endl;
+            }
+            if (g_options.enableConnectionAnalysis) {
+                summaryFile << "- Kitay_Kazik_inheritance_edges.txt (Child -> parent edge list)" << std::endl;
+            }
 
             summaryFile.close();
         }
     }
 
+    if (g_options.enableConnectionAnalysis) {
+        WriteInheritanceEdges(basePath + "Kitay_Kazik_inheritance_edges.txt");
+    }
+
+    if (g_options.enableDumpIndex) {
+        WriteIndexFile();
+    }
+
     LogLine("[OUTPUT] Reports generated in: %s", basePath.c_str());
 }
 
+#if defined(_WIN64)
+// Runtime generation for the live passes: the configured version, else the
+// one MetadataCatalogPass read from the metadata header, else 24.
+static Il2CppRuntime SelectRuntime() {
+    int version = g_options.il2cppRuntimeVersion;
+    if (version == 0) version = g_metadataVersion;
+    return Il2CppRuntimeForVersion(version == 0 ? 24 : version);
+}
+
+// The passes that read runtime il2cpp structures, instantiated per layout.
+template <typename Layout>
+static void RunLayoutPasses(bool catalogued) {
+    LogLine("[LAYOUT] Reading il2cpp structures as %s", Layout::Name());
+
+    if (!catalogued && g_options.enableFieldTypes && g_options.enableRuntimeTypeDirectory) {
+        BuildTypeDefinitionDirectory();
+    }
+
+    if (!catalogued && !NameJoinDiscovery<Layout>()) {
+        ClassDiscoveryWithOptions<Layout>();
+    }
+    LogLine("");
+
+    StringXrefPass<Layout>();
+}
+#endif
+
 static DWORD WINAPI LiveMonitoringThread(LPVOID) {
     if (!g_options.enableConsoleMonitoring) return 0;
 
@@ -1053,6 +3636,14 @@ DWORD WINAPI Run(LPVOID) {
     DisplayCurrentOptions();
     LogLine("");
 
+    if (g_options.enableSnapshotCapture) {
+        CaptureSnapshot();
+        LogLine("Files location: %s", TempPath("").c_str());
+        return 0;
+    }
+
+    StartQueryServer();
+
     if (g_options.enableConsoleMonitoring) {
         g_liveMonitoring = true;
         HANDLE monitorThread = CreateThread(NULL, 0, LiveMonitoringThread, NULL, 0, NULL);
@@ -1067,11 +3658,31 @@ DWORD WINAPI Run(LPVOID) {
         }
     }
 
+    GovernorBegin();
+
     ExtractStringsWithOptions();
     LogLine("");
 
-    ClassDiscoveryWithOptions();
-    LogLine("");
+#if defined(_WIN64)
+    bool catalogued = MetadataCatalogPass();
+    if (SelectRuntime() == Il2CppRuntime::V29) {
+        RunLayoutPasses<Il2CppLayoutV29>(catalogued);
+    }
+    else {
+        RunLayoutPasses<Il2CppLayoutV24>(catalogued);
+    }
+#else
+    MetadataCatalogPass();
+    LogLine("[LAYOUT] No il2cpp class layout for 32-bit runtimes, skipping discovery and string xrefs");
+#endif
+    HeapCensusPass();
+
+    if (g_options.enableCompressedOutput) {
+        CloseCompressedSinks();
+        LogLine("[OUTPUT] Compressed sinks: %llu raw bytes -> %llu bytes written",
+            static_cast<unsigned long long>(g_compressedRawBytes.load()),
+            static_cast<unsigned long long>(g_compressedStoredBytes.load()));
+    }
 
     GenerateOptionsBasedReports();
 
@@ -1082,16 +3693,29 @@ DWORD WINAPI Run(LPVOID) {
     LogLine("Addresses discovered: %d", g_addressCount.load());
     LogLine("Total strings: %d", g_stringCount.load());
 
+    if (g_options.enableFieldTypes) {
+        LogLine("Field type cache: %llu hits, %llu decodes",
+            static_cast<unsigned long long>(g_typeNameCache.hits.load()),
+            static_cast<unsigned long long>(g_typeNameCache.misses.load()));
+    }
+
+    LogLine("MethodInfo cache: %llu hits, %llu decodes",
+        static_cast<unsigned long long>(g_methodCache.hits.load()),
+        static_cast<unsigned long long>(g_methodCache.misses.load()));
+
     if (g_options.enableVectorTracking) {
         LogLine("Vector changes detected: %d", g_vectorChangeCount.load());
-        LogLine("Vectors tracked: %zu", g_allTrackedVectors.size());
+        LogLine("Vectors tracked: %zu", g_allTrackedVectors.Size());
     }
 
     LogLine("");
     LogLine("Files location: %s", TempPath("").c_str());
     LogLine("Dumper completed with selected options!");
+    g_dumpComplete = true;
 
-    if (g_options.enableConsoleMonitoring && g_liveMonitoring) {
+    bool monitored = g_options.enableConsoleMonitoring && g_liveMonitoring;
+
+    if (monitored) {
         for (int i = 0; i < 600; i++) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
             if (i % 60 == 0) {
@@ -1102,6 +3726,8 @@ DWORD WINAPI Run(LPVOID) {
         g_liveMonitoring = false;
     }
 
+    StopQueryServer(monitored);
+
     return 0;
 
 }
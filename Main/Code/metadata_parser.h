@@ -0,0 +1,292 @@
+#pragma once
+
+// Offline reader for il2cpp global-metadata.dat, shared by the dumper and
+// /Tools. The file is mapped read-only and the type, field, method and
+// string tables are decoded in place; names are string_views into the map.
+//
+// Supported versions are 24 (24.0, 24.1, 24.2-24.5), 27 - 29 and 31. The
+// header does not carry the 24.x sub-version, so each candidate record
+// layout is tried in turn: every table size must divide evenly and the
+// leading records must carry tokens of the right table (0x02 types, 0x04
+// fields, 0x06 methods).
+//
+// Runtime data (field offsets, method pointers, Il2CppType) lives in the
+// game binary, not here; records carry metadata tokens instead.
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+constexpr uint32_t kMetadataSanity = 0xFAB11BAF;
+
+// Index of the (offset, size) pair in the header, counted after sanity and version.
+enum MetadataSectionIndex {
+    kSectionStrings = 2,
+    kSectionMethods = 5,
+    kSectionFields = 11,
+    kSectionTypeDefinitions = 19,
+};
+
+struct MetadataLayout {
+    const char* name;
+    int minVersion;
+    int maxVersion;
+    uint32_t typeSize;
+    uint32_t typeFlagsSlot;
+    uint32_t methodSize;
+    uint32_t fieldSize;
+};
+
+// Il2CppTypeDefinition: name, namespace, then a version-dependent run of
+// indices up to flags; fieldStart and methodStart follow flags, and the u16
+// counts start eight slots later. Il2CppMethodDefinition ends with token and
+// four u16s; Il2CppFieldDefinition ends with token.
+constexpr MetadataLayout kMetadataLayouts[] = {
+    { "24.2", 24, 24, 92, 8, 32, 12 },
+    { "24.1", 24, 24, 100, 10, 52, 12 },
+    { "24.0", 24, 24, 104, 11, 56, 16 },
+    { "27", 27, 29, 88, 7, 32, 12 },
+    { "31", 31, 31, 88, 7, 36, 12 },
+};
+
+struct MetadataField {
+    std::string_view name;
+    int32_t typeIndex;
+    uint32_t token;
+};
+
+struct MetadataMethod {
+    std::string_view name;
+    uint32_t token;
+    uint16_t flags;
+    uint16_t parameterCount;
+};
+
+struct MetadataClass {
+    bool valid = false;
+    uint32_t index = 0;
+    uint32_t token = 0;
+    uint32_t flags = 0;
+    std::string_view name;
+    std::string_view nameSpace;
+    std::vector<MetadataField> fields;
+    std::vector<MetadataMethod> methods;
+
+    std::string FullName() const {
+        std::string fullName(nameSpace);
+        if (!fullName.empty()) fullName += "::";
+        fullName.append(name.data(), name.size());
+        return fullName;
+    }
+};
+
+inline uint32_t MetadataLoad32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint16_t MetadataLoad16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+struct MetadataFile {
+    struct Section {
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+    };
+
+    MappedFile file;
+    int version = 0;
+    const MetadataLayout* layout = nullptr;
+    Section strings;
+    Section types;
+    Section fields;
+    Section methods;
+    uint32_t typeCount = 0;
+    uint32_t fieldCount = 0;
+    uint32_t methodCount = 0;
+
+    bool Open(const char* path, std::string& error) {
+        if (!file.Open(path)) {
+            error = "cannot map file";
+            return false;
+        }
+        if (file.size < 8 + (kSectionTypeDefinitions + 1) * 8 || MetadataLoad32(file.data) != kMetadataSanity) {
+            error = "not a plain global-metadata file (bad sanity; encrypted?)";
+            return false;
+        }
+
+        version = static_cast<int>(MetadataLoad32(file.data + 4));
+        if (!ReadSection(kSectionStrings, strings) || !ReadSection(kSectionTypeDefinitions, types) ||
+            !ReadSection(kSectionFields, fields) || !ReadSection(kSectionMethods, methods)) {
+            error = "section outside the file";
+            return false;
+        }
+
+        for (const auto& candidate : kMetadataLayouts) {
+            if (version >= candidate.minVersion && version <= candidate.maxVersion && TryLayout(candidate)) {
+                layout = &candidate;
+                return true;
+            }
+        }
+
+        error = "unsupported metadata version " + std::to_string(version);
+        return false;
+    }
+
+    // NUL-terminated entry of the string table; empty if out of range.
+    std::string_view String(uint32_t index) const {
+        if (index >= strings.size) return {};
+        const char* start = reinterpret_cast<const char*>(strings.data) + index;
+        const void* end = std::memchr(start, 0, strings.size - index);
+        return std::string_view(start, end ? static_cast<const char*>(end) - start : strings.size - index);
+    }
+
+    bool DecodeClass(uint32_t index, MetadataClass& out) const {
+        if (index >= typeCount) return false;
+        const uint8_t* record = types.data + size_t(index) * layout->typeSize;
+        uint32_t flagsSlot = layout->typeFlagsSlot;
+        const uint8_t* counts = record + (flagsSlot + 9) * 4;
+
+        out.index = index;
+        out.name = String(MetadataLoad32(record));
+        out.nameSpace = String(MetadataLoad32(record + 4));
+        out.flags = MetadataLoad32(record + flagsSlot * 4);
+        out.token = MetadataLoad32(counts + 20);
+
+        uint32_t fieldStart = MetadataLoad32(record + (flagsSlot + 1) * 4);
+        uint32_t methodStart = MetadataLoad32(record + (flagsSlot + 2) * 4);
+        uint16_t methodTotal = MetadataLoad16(counts);
+        uint16_t fieldTotal = MetadataLoad16(counts + 4);
+
+        out.fields.clear();
+        if (fieldTotal > 0 && fieldStart < fieldCount && fieldTotal <= fieldCount - fieldStart) {
+            out.fields.reserve(fieldTotal);
+            for (uint32_t i = fieldStart; i < fieldStart + fieldTotal; i++) {
+                const uint8_t* field = fields.data + size_t(i) * layout->fieldSize;
+                out.fields.push_back({ String(MetadataLoad32(field)), static_cast<int32_t>(MetadataLoad32(field + 4)),
+                    MetadataLoad32(field + layout->fieldSize - 4) });
+            }
+        }
+
+        out.methods.clear();
+        if (methodTotal > 0 && methodStart < methodCount && methodTotal <= methodCount - methodStart) {
+            out.methods.reserve(methodTotal);
+            for (uint32_t i = methodStart; i < methodStart + methodTotal; i++) {
+                const uint8_t* method = methods.data + size_t(i) * layout->methodSize;
+                const uint8_t* tail = method + layout->methodSize - 8;
+                out.methods.push_back({ String(MetadataLoad32(method)), MetadataLoad32(tail - 4),
+                    MetadataLoad16(tail), MetadataLoad16(tail + 6) });
+            }
+        }
+
+        out.valid = !out.name.empty();
+        return out.valid;
+    }
+
+private:
+    // Pair order is stable from version 24 on.
+    bool ReadSection(int index, Section& section) const {
+        const uint8_t* pair = file.data + 8 + size_t(index) * 8;
+        uint32_t offset = MetadataLoad32(pair);
+        uint32_t size = MetadataLoad32(pair + 4);
+        if (uint64_t(offset) + size > file.size) return false;
+        section.data = file.data + offset;
+        section.size = size;
+        return true;
+    }
+
+    bool TryLayout(const MetadataLayout& candidate) {
+        if (types.size % candidate.typeSize || fields.size % candidate.fieldSize || methods.size % candidate.methodSize) {
+            return false;
+        }
+
+        auto tokensMatch = [](const Section& section, uint32_t recordSize, uint32_t tokenOffset, uint32_t table) {
+            uint32_t count = (std::min)(section.size / recordSize, 64u);
+            for (uint32_t i = 0; i < count; i++) {
+                if (MetadataLoad32(section.data + size_t(i) * recordSize + tokenOffset) >> 24 != table) return false;
+            }
+            return true;
+        };
+
+        if (!tokensMatch(types, candidate.typeSize, (candidate.typeFlagsSlot + 9) * 4 + 20, 0x02) ||
+            !tokensMatch(fields, candidate.fieldSize, candidate.fieldSize - 4, 0x04) ||
+            !tokensMatch(methods, candidate.methodSize, candidate.methodSize - 12, 0x06)) {
+            return false;
+        }
+
+        typeCount = types.size / candidate.typeSize;
+        fieldCount = fields.size / candidate.fieldSize;
+        methodCount = methods.size / candidate.methodSize;
+        return true;
+    }
+};
+
+// Member lines as they appear in the dump's Fields/Methods sections.
+inline std::string MetadataFieldLine(const MetadataField& field) {
+    char token[32];
+    std::snprintf(token, sizeof(token), " [token: 0x%08x]", field.token);
+    return std::string(field.name) + token;
+}
+
+inline std::string MetadataMethodLine(const MetadataMethod& method) {
+    char token[32];
+    std::snprintf(token, sizeof(token), "() [token: 0x%08x]", method.token);
+    return std::string(method.name) + token;
+}
+
+// Decodes every type definition on worker threads, then calls fn for each
+// valid class in type order on the calling thread. Each extra worker thread
+// runs its share as runWorker(work), so the caller can set its priority or
+// account for its CPU time around the call.
+template <typename Fn, typename RunWorker>
+inline size_t ParseMetadataClasses(const MetadataFile& metadata, int workers, Fn&& fn, RunWorker runWorker) {
+    constexpr uint32_t kBatch = 256;
+    std::vector<MetadataClass> classes(metadata.typeCount);
+    std::atomic<uint32_t> next{ 0 };
+
+    auto work = [&] {
+        for (;;) {
+            uint32_t start = next.fetch_add(kBatch);
+            if (start >= metadata.typeCount) return;
+            uint32_t end = (std::min)(start + kBatch, metadata.typeCount);
+            for (uint32_t i = start; i < end; i++) {
+                metadata.DecodeClass(i, classes[i]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers; i++) {
+        threads.emplace_back([&] { runWorker(work); });
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t emitted = 0;
+    for (const auto& cls : classes) {
+        if (!cls.valid) continue;
+        fn(cls);
+        emitted++;
+    }
+    return emitted;
+}
+
+template <typename Fn>
+inline size_t ParseMetadataClasses(const MetadataFile& metadata, int workers, Fn&& fn) {
+    return ParseMetadataClasses(metadata, workers, std::forward<Fn>(fn), [](const auto& work) { work(); });
+}
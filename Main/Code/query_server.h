@@ -0,0 +1,494 @@
+#pragma once
+
+// Local query endpoint over the dump results, shared by the dumper and
+// /Tools. Windows listens on a named pipe (\\.\pipe\<name>), everything else
+// on a Unix socket (/tmp/<name>.sock, or <name> itself if it is a path).
+//
+// One request per line. A reply is zero or more record lines followed by
+// ". <count>"; a request that does not parse gets "! bad request" first.
+//   name <text>       records whose Class::member name contains text
+//   addr <address>    records at exactly this address
+//   range <lo> <hi>   records with lo <= address <= hi
+//   stats             "key value" lines
+//   watch             no reply; every record found from now on is streamed
+//                     as it is published, until the client hangs up
+// Record line: <Type> 0x<address> <Class>[::<member>]
+
+#include "format_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+enum QueryKind {
+    kQueryInvalid = 0,
+    kQueryName,
+    kQueryAddress,
+    kQueryRange,
+    kQueryStats,
+    kQueryWatch,
+};
+
+struct QueryRequest {
+    QueryKind kind = kQueryInvalid;
+    std::string_view text;
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+};
+
+// Parses one or two numbers (decimal or 0x-prefixed hex) off the front of text.
+inline bool ParseQueryNumbers(std::string_view text, uint64_t* values, int count) {
+    char buffer[64];
+    if (text.size() >= sizeof(buffer)) return false;
+    buffer[text.copy(buffer, text.size())] = 0;
+
+    char* cursor = buffer;
+    for (int i = 0; i < count; i++) {
+        char* end = nullptr;
+        values[i] = std::strtoull(cursor, &end, 0);
+        if (end == cursor) return false;
+        cursor = end;
+    }
+    return true;
+}
+
+inline QueryRequest ParseQueryRequest(std::string_view line) {
+    QueryRequest request;
+    size_t space = line.find(' ');
+    std::string_view verb = line.substr(0, space);
+    std::string_view rest = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+
+    uint64_t values[2] = {};
+    if (verb == "name" && !rest.empty()) {
+        request.kind = kQueryName;
+        request.text = rest;
+    }
+    else if (verb == "addr" && ParseQueryNumbers(rest, values, 1)) {
+        request.kind = kQueryAddress;
+        request.lo = request.hi = values[0];
+    }
+    else if (verb == "range" && ParseQueryNumbers(rest, values, 2) && values[0] <= values[1]) {
+        request.kind = kQueryRange;
+        request.lo = values[0];
+        request.hi = values[1];
+    }
+    else if (verb == "stats") {
+        request.kind = kQueryStats;
+    }
+    else if (verb == "watch") {
+        request.kind = kQueryWatch;
+    }
+    return request;
+}
+
+template <typename Buffer>
+inline void QueryRecordLine(Buffer& line, std::string_view type, uint64_t address,
+    std::string_view className, std::string_view member) {
+    line << type << ' ' << Hex(address) << ' ' << className;
+    if (!member.empty()) line << "::" << member;
+    line << '\n';
+}
+
+inline std::string QueryEndpointPath(std::string_view name) {
+#ifdef _WIN32
+    return "\\\\.\\pipe\\" + std::string(name);
+#else
+    if (name.find('/') != std::string_view::npos) return std::string(name);
+    return "/tmp/" + std::string(name) + ".sock";
+#endif
+}
+
+// One connected byte stream, client or server side.
+struct QueryChannel {
+    static constexpr size_t kMaxLine = 4096;
+
+#ifdef _WIN32
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    std::string pending;
+
+    QueryChannel() = default;
+    QueryChannel(const QueryChannel&) = delete;
+    QueryChannel& operator=(const QueryChannel&) = delete;
+    ~QueryChannel() { Close(); }
+
+    bool Connect(std::string_view endpoint) {
+        Close();
+        std::string path = QueryEndpointPath(endpoint);
+#ifdef _WIN32
+        for (int attempt = 0; attempt < 2; attempt++) {
+            handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+            if (handle != INVALID_HANDLE_VALUE) return true;
+            if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(path.c_str(), 2000)) return false;
+        }
+        return false;
+#else
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            Close();
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    bool Write(std::string_view data) {
+        while (!data.empty()) {
+#ifdef _WIN32
+            DWORD written = 0;
+            DWORD chunk = static_cast<DWORD>((std::min)(data.size(), size_t(1) << 20));
+            if (!WriteFile(handle, data.data(), chunk, &written, nullptr) || written == 0) return false;
+#else
+            ssize_t written = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+#endif
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    // Next line without its terminator; false on hang-up or an overlong line.
+    bool ReadLine(std::string& line) {
+        for (;;) {
+            size_t newline = pending.find('\n');
+            if (newline != std::string::npos) {
+                line.assign(pending, 0, newline);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                pending.erase(0, newline + 1);
+                return true;
+            }
+            if (pending.size() > kMaxLine) return false;
+
+            char buffer[4096];
+#ifdef _WIN32
+            DWORD got = 0;
+            if (!ReadFile(handle, buffer, sizeof(buffer), &got, nullptr) || got == 0) return false;
+#else
+            ssize_t got = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+#endif
+            pending.append(buffer, static_cast<size_t>(got));
+        }
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+        handle = INVALID_HANDLE_VALUE;
+#else
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        pending.clear();
+    }
+};
+
+// Answers a name, addr or range request from a record source, for handlers:
+// forEach(emit) calls emit(type, address, className, member) once per record.
+// Matches are collected and written to channel after forEach returns, so a
+// slow client never holds up whatever forEach locks. Returns the count.
+template <typename ForEachRecord>
+inline size_t AnswerRecordQuery(const QueryRequest& request, QueryChannel& channel, ForEachRecord&& forEach) {
+    std::string reply;
+    size_t count = 0;
+    forEach([&](std::string_view type, uint64_t address, std::string_view className, std::string_view member) {
+        if (request.kind == kQueryName) {
+            LineBuffer fullName;
+            fullName << className;
+            if (!member.empty()) fullName << "::" << member;
+            if (fullName.View().find(request.text) == std::string_view::npos) return;
+        }
+        else if (request.kind != kQueryAddress && request.kind != kQueryRange) {
+            return;
+        }
+        else if (address < request.lo || address > request.hi) {
+            return;
+        }
+
+        LineBuffer line;
+        QueryRecordLine(line, type, address, className, member);
+        reply.append(line.data, line.size);
+        count++;
+    });
+
+    channel.Write(reply);
+    return count;
+}
+
+// Accepts clients on their own threads and answers requests through handler.
+// Publish feeds watch clients; it only appends to per-client outboxes, so a
+// slow reader never stalls the scan thread that found the record.
+struct QueryServer {
+    // Writes the matching record lines to channel and returns how many; the
+    // server adds the ". <count>" terminator.
+    using Handler = std::function<size_t(const QueryRequest&, QueryChannel&)>;
+
+    static constexpr size_t kMaxOutbox = 16u << 20;
+
+    struct Connection {
+        QueryChannel channel;
+        std::thread thread;
+        std::atomic<bool> finished{ false };
+        std::string outbox;
+    };
+
+    std::string path;
+    Handler handler;
+    std::atomic<bool> running{ false };
+    std::atomic<int> watcherCount{ 0 };
+    std::atomic<uint64_t> droppedBytes{ 0 };
+    std::thread acceptThread;
+    std::atomic<bool> acceptFinished{ false };
+#ifdef _WIN32
+    HANDLE firstPipe = INVALID_HANDLE_VALUE;
+#else
+    int listenFd = -1;
+#endif
+
+    std::mutex connectionMutex;
+    std::vector<std::unique_ptr<Connection>> connections;
+
+    std::mutex outboxMutex;
+    std::condition_variable outboxReady;
+    std::vector<Connection*> watchers;
+
+    QueryServer() = default;
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+    ~QueryServer() { Stop(); }
+
+    bool Start(std::string_view name, Handler fn) {
+        if (running) return false;
+        path = QueryEndpointPath(name);
+        handler = std::move(fn);
+#ifdef _WIN32
+        firstPipe = CreatePipeInstance(true);
+        if (firstPipe == INVALID_HANDLE_VALUE) return false;
+#else
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) return false;
+        ::unlink(path.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 16) != 0) {
+            ::close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+#endif
+        running = true;
+        acceptFinished = false;
+        acceptThread = std::thread([this] {
+            AcceptLoop();
+            acceptFinished = true;
+        });
+        return true;
+    }
+
+    bool HasWatchers() const {
+        return watcherCount.load(std::memory_order_relaxed) > 0;
+    }
+
+    void Publish(std::string_view lines) {
+        if (!HasWatchers()) return;
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        for (Connection* watcher : watchers) {
+            if (watcher->outbox.size() + lines.size() > kMaxOutbox) {
+                droppedBytes += lines.size();
+                continue;
+            }
+            watcher->outbox.append(lines.data(), lines.size());
+        }
+        outboxReady.notify_all();
+    }
+
+    void Stop() {
+        if (!running.exchange(false)) return;
+        {
+            std::lock_guard<std::mutex> lock(outboxMutex);
+            outboxReady.notify_all();
+        }
+
+#ifndef _WIN32
+        ::shutdown(listenFd, SHUT_RDWR);
+#endif
+        while (!acceptFinished) {
+            Interrupt(acceptThread, nullptr);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        acceptThread.join();
+#ifndef _WIN32
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(path.c_str());
+#endif
+
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        for (auto& connection : connections) {
+            while (!connection->finished) {
+                Interrupt(connection->thread, &connection->channel);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            connection->thread.join();
+        }
+        connections.clear();
+    }
+
+private:
+    // Unblocks a thread stuck in accept, read or write.
+    static void Interrupt(std::thread& thread, QueryChannel* channel) {
+#ifdef _WIN32
+        (void)channel;
+        CancelSynchronousIo(thread.native_handle());
+#else
+        (void)thread;
+        if (channel && channel->fd >= 0) ::shutdown(channel->fd, SHUT_RDWR);
+#endif
+    }
+
+#ifdef _WIN32
+    HANDLE CreatePipeInstance(bool first) {
+        DWORD openMode = PIPE_ACCESS_DUPLEX | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+        return CreateNamedPipeA(path.c_str(), openMode, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT |
+            PIPE_REJECT_REMOTE_CLIENTS, PIPE_UNLIMITED_INSTANCES, 64 * 1024, 4 * 1024, 0, nullptr);
+    }
+#endif
+
+    void AcceptLoop() {
+#ifdef _WIN32
+        HANDLE pipe = firstPipe;
+        firstPipe = INVALID_HANDLE_VALUE;
+        while (running) {
+            if (pipe == INVALID_HANDLE_VALUE) pipe = CreatePipeInstance(false);
+            if (pipe == INVALID_HANDLE_VALUE) break;
+            bool connected = ConnectNamedPipe(pipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+            if (!connected || !running) {
+                CloseHandle(pipe);
+                pipe = INVALID_HANDLE_VALUE;
+                continue;
+            }
+            Accept([&](QueryChannel& channel) { channel.handle = pipe; });
+            pipe = INVALID_HANDLE_VALUE;
+        }
+        if (pipe != INVALID_HANDLE_VALUE) CloseHandle(pipe);
+#else
+        while (running) {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (!running) {
+                ::close(fd);
+                break;
+            }
+            Accept([&](QueryChannel& channel) { channel.fd = fd; });
+        }
+#endif
+    }
+
+    template <typename Attach>
+    void Accept(Attach&& attach) {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        for (auto it = connections.begin(); it != connections.end();) {
+            if ((*it)->finished) {
+                (*it)->thread.join();
+                it = connections.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        auto connection = std::make_unique<Connection>();
+        attach(connection->channel);
+        Connection* raw = connection.get();
+        connection->thread = std::thread([this, raw] {
+            Serve(*raw);
+            raw->finished = true;
+        });
+        connections.push_back(std::move(connection));
+    }
+
+    void Serve(Connection& connection) {
+        std::string line;
+        while (running && connection.channel.ReadLine(line)) {
+            QueryRequest request = ParseQueryRequest(line);
+            if (request.kind == kQueryWatch) {
+                Watch(connection);
+                return;
+            }
+
+            LineBuffer end;
+            size_t count = 0;
+            if (request.kind == kQueryInvalid) {
+                end << "! bad request\n";
+            }
+            else {
+                count = handler(request, connection.channel);
+            }
+            end << ". " << count << '\n';
+            if (!connection.channel.Write(end.View())) return;
+        }
+    }
+
+    void Watch(Connection& connection) {
+        {
+            std::lock_guard<std::mutex> lock(outboxMutex);
+            watchers.push_back(&connection);
+            watcherCount++;
+        }
+
+        std::string batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(outboxMutex);
+                outboxReady.wait(lock, [&] { return !running || !connection.outbox.empty(); });
+                if (!running) break;
+                batch.swap(connection.outbox);
+            }
+            if (!connection.channel.Write(batch)) break;
+            batch.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        watchers.erase(std::find(watchers.begin(), watchers.end(), &connection));
+        watcherCount--;
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+// Quality score for printable runs found by the string pass. Raw memory is
+// full of short accidental runs ("a$X", "~~~~", base64-ish noise); these
+// score low and are dropped before anything stores, matches or writes them.
+//
+// Character classes and adjacent repeats are counted 16 bytes at a time with
+// SSE2; the tail, case transitions and the byte histogram for entropy go
+// through a 128-entry class table. Input is assumed printable (32..126).
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define KAZIK_STRING_SCORE_SSE2 1
+#endif
+
+enum StringCharClass : uint8_t {
+    kCharOther = 0,
+    kCharLower = 1,
+    kCharUpper = 2,
+    kCharDigit = 3,
+    kCharIdent = 4,  // _ . : < > ` - characters that appear inside type and member names
+    kCharSpace = 5,
+    kCharRare = 6,       // punctuation that real text and names seldom use
+    kCharSeparator = 7,  // / and \ in paths and URLs
+    kCharSyntax = 8,     // quotes, brackets and delimiters of text, JSON and format strings
+};
+
+struct StringCharTable {
+    uint8_t classes[128];
+
+    constexpr StringCharTable() : classes() {
+        for (int c = 'a'; c <= 'z'; c++) classes[c] = kCharLower;
+        for (int c = 'A'; c <= 'Z'; c++) classes[c] = kCharUpper;
+        for (int c = '0'; c <= '9'; c++) classes[c] = kCharDigit;
+        classes[static_cast<int>('_')] = kCharIdent;
+        classes[static_cast<int>('.')] = kCharIdent;
+        classes[static_cast<int>(':')] = kCharIdent;
+        classes[static_cast<int>('<')] = kCharIdent;
+        classes[static_cast<int>('>')] = kCharIdent;
+        classes[static_cast<int>('`')] = kCharIdent;
+        classes[static_cast<int>('-')] = kCharIdent;
+        classes[static_cast<int>(' ')] = kCharSpace;
+        for (char c : "~^|$@*+#") {
+            if (c) classes[static_cast<int>(c)] = kCharRare;
+        }
+        classes[static_cast<int>('/')] = kCharSeparator;
+        classes[static_cast<int>('\\')] = kCharSeparator;
+        for (char c : "\"',;=&?!%(){}[]") {
+            if (c) classes[static_cast<int>(c)] = kCharSyntax;
+        }
+    }
+};
+
+constexpr StringCharTable kStringCharTable;
+
+struct StringFeatures {
+    uint32_t length = 0;
+    uint32_t lower = 0;
+    uint32_t upper = 0;
+    uint32_t digit = 0;
+    uint32_t ident = 0;
+    uint32_t space = 0;
+    uint32_t repeats = 0;       // bytes equal to their predecessor
+    uint32_t transitions = 0;   // lower -> upper steps, "aXbY" has two
+    uint32_t digitSwitches = 0; // letter <-> digit steps, "a9b" has two
+    uint32_t rare = 0;
+    uint32_t separator = 0;
+    uint32_t syntax = 0;
+    bool identifierShape = false;
+    bool numericShape = false;    // numbers, versions, dates and times: "100", "2.5.1", "12:30:45"
+    bool bracketedShape = false;  // opens and closes with a matching pair: {...}, [...], "..."
+    double entropy = 0.0;       // bits per byte, only measured from 8 bytes up
+
+    uint32_t Other() const { return length - lower - upper - digit - ident - space; }
+};
+
+// Thresholds are percentages of the length, entropy in tenths of a bit.
+struct StringScoreLimits {
+    int minScore = 60;
+    int maxPunctPercent = 30;
+    int maxRepeatPercent = 60;
+    int minEntropyTenths = 15;
+    int maxEntropyTenths = 53;
+};
+
+inline StringFeatures MeasureString(const char* data, size_t length) {
+    StringFeatures f;
+    f.length = static_cast<uint32_t>(length);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t i = 0;
+    size_t vectorEnd = 0;
+
+#ifdef KAZIK_STRING_SCORE_SSE2
+    auto count = [](__m128i mask) {
+        uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(mask));
+        bits = bits - ((bits >> 1) & 0x5555);
+        bits = (bits & 0x3333) + ((bits >> 2) & 0x3333);
+        bits = (bits + (bits >> 4)) & 0x0F0F;
+        return (bits + (bits >> 8)) & 0x1F;
+    };
+    auto inRange = [](__m128i v, char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+            _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+    };
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        f.lower += count(inRange(v, 'a', 'z'));
+        f.upper += count(inRange(v, 'A', 'Z'));
+        f.digit += count(inRange(v, '0', '9'));
+        f.space += count(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+        __m128i ident = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8('`')))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('<')), _mm_cmpeq_epi8(v, _mm_set1_epi8('>'))),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('-'))));
+        f.ident += count(ident);
+        if (i + 17 <= length) {
+            __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 1));
+            f.repeats += count(_mm_cmpeq_epi8(v, next));
+        }
+        else {
+            for (size_t j = i + 1; j < length; j++) f.repeats += bytes[j] == bytes[j - 1];
+        }
+    }
+    vectorEnd = i;
+#endif
+
+    for (; i < length; i++) {
+        switch (kStringCharTable.classes[bytes[i] & 0x7F]) {
+        case kCharLower: f.lower++; break;
+        case kCharUpper: f.upper++; break;
+        case kCharDigit: f.digit++; break;
+        case kCharIdent: f.ident++; break;
+        case kCharSpace: f.space++; break;
+        default: break;
+        }
+        if (i > vectorEnd) f.repeats += bytes[i] == bytes[i - 1];
+    }
+
+    if (length == 0) return f;
+
+    uint8_t first = kStringCharTable.classes[bytes[0] & 0x7F];
+    f.identifierShape = (first == kCharLower || first == kCharUpper || bytes[0] == '_') &&
+        f.space == 0 && f.lower + f.upper + f.digit + f.ident == f.length;
+
+    auto isLetter = [](uint8_t c) { return c == kCharLower || c == kCharUpper; };
+    auto isNumeric = [](uint8_t c) { return c == '.' || c == ',' || c == ':' || c == '-'; };
+    uint8_t previous = first;
+    f.rare = first == kCharRare;
+    f.separator = first == kCharSeparator;
+    f.syntax = first == kCharSyntax;
+    uint32_t numericPunct = isNumeric(bytes[0]);
+    bool loosePunct = false;  // numeric punctuation not followed by a digit
+    for (size_t j = 1; j < length; j++) {
+        uint8_t current = kStringCharTable.classes[bytes[j] & 0x7F];
+        f.transitions += previous == kCharLower && current == kCharUpper;
+        f.digitSwitches += (isLetter(previous) && current == kCharDigit) || (previous == kCharDigit && isLetter(current));
+        f.rare += current == kCharRare;
+        f.separator += current == kCharSeparator;
+        f.syntax += current == kCharSyntax;
+        numericPunct += isNumeric(bytes[j]);
+        loosePunct |= isNumeric(bytes[j - 1]) && current != kCharDigit;
+        previous = current;
+    }
+
+    // Text opens and closes its brackets and quotes; a stray one is noise.
+    int parens = 0, braces = 0, brackets = 0;
+    uint32_t quotes = 0, stray = 0;
+    for (size_t j = 0; j < length; j++) {
+        switch (bytes[j]) {
+        case '(': parens++; break;
+        case '{': braces++; break;
+        case '[': brackets++; break;
+        case ')': if (--parens < 0) { stray++; parens = 0; } break;
+        case '}': if (--braces < 0) { stray++; braces = 0; } break;
+        case ']': if (--brackets < 0) { stray++; brackets = 0; } break;
+        case '"': quotes++; break;
+        default: break;
+        }
+    }
+    stray += parens + braces + brackets + (quotes & 1);
+    f.syntax -= stray;
+    f.rare += stray;
+
+    // Up to two letters allow Unity-style versions such as "2021.3.5f1".
+    uint8_t last = bytes[length - 1];
+    uint32_t letters = f.lower + f.upper;
+    f.numericShape = f.digit > 0 && letters <= 2 && !loosePunct && !isNumeric(last) &&
+        f.digit + letters + numericPunct == f.length &&
+        f.digit * 2 >= f.length && (first == kCharDigit || bytes[0] == '-');
+    f.bracketedShape = length >= 2 && ((bytes[0] == '{' && last == '}') || (bytes[0] == '[' && last == ']') ||
+        (bytes[0] == '(' && last == ')') || (bytes[0] == '"' && last == '"'));
+
+    if (length >= 8) {
+        uint16_t histogram[128] = {};
+        for (size_t j = 0; j < length; j++) histogram[bytes[j] & 0x7F]++;
+        double sum = 0.0;
+        for (uint16_t c : histogram) {
+            if (c) sum += c * std::log2(static_cast<double>(c));
+        }
+        f.entropy = std::log2(static_cast<double>(length)) - sum / static_cast<double>(length);
+    }
+    return f;
+}
+
+// 0..100; the string pass keeps anything at or above limits.minScore.
+inline int ScoreString(const StringFeatures& f, const StringScoreLimits& limits) {
+    if (f.length == 0) return 0;
+
+    // Separators count as word characters; inside a bracketed string so does
+    // half the syntax, so paths and JSON are not scored as punctuation noise.
+    uint32_t letters = f.lower + f.upper;
+    uint32_t alnumPercent = (letters + f.digit + f.separator + (f.bracketedShape ? f.syntax / 2 : 0)) * 100 / f.length;
+    uint32_t otherPercent = (f.rare + (f.bracketedShape ? f.syntax / 2 : f.syntax)) * 100 / f.length;
+    uint32_t repeatPercent = f.length > 1 ? f.repeats * 100 / (f.length - 1) : 0;
+
+    int score = static_cast<int>(alnumPercent * 60 / 100);
+    if (f.identifierShape || f.numericShape) score += 20;
+    if (f.bracketedShape) score += 20;
+    if (f.separator >= 2 && f.separator * 4 <= f.length && letters * 2 >= f.length && f.rare == 0) score += 10;
+    if (letters * 100 >= f.length * 60 && otherPercent <= 25) score += 10;
+    score += f.transitions * 6 <= f.length ? 10 : -20;
+    if (f.digitSwitches * 5 > f.length) score -= 20;
+    if (f.rare * 20 > f.length) score -= 30;
+    if (f.separator * 3 > f.length) score -= 30;
+
+    if (f.length < 6 && !f.identifierShape && !f.numericShape) score -= 30;
+    if (static_cast<int>(repeatPercent) > limits.maxRepeatPercent) score -= 40;
+    if (static_cast<int>(otherPercent) > limits.maxPunctPercent) score -= 30;
+    if (f.length >= 8) {
+        int entropyTenths = static_cast<int>(f.entropy * 10.0);
+        bool tooFlat = entropyTenths < limits.minEntropyTenths;
+        bool tooRandom = f.length >= 64 && entropyTenths > limits.maxEntropyTenths;
+        if (tooFlat || tooRandom) score -= 30;
+    }
+
+    return score < 0 ? 0 : (score > 100 ? 100 : score);
+}
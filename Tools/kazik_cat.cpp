@@ -0,0 +1,70 @@
+// Decompresses KZF frame files written by the dumper to stdout.
+//
+// Build: g++ -std=c++17 -O2 -IMain/Code Tools/kazik_cat.cpp -o kazik_cat
+// Usage: kazik_cat [-s] <file.kzf>...
+//   -s  print frame statistics to stderr instead of the decoded text
+
+#include "frame_codec.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static int CatFile(const char* path, bool statsOnly) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "kazik_cat: cannot open %s\n", path);
+        return 1;
+    }
+
+    FrameHeader header;
+    std::vector<uint8_t> raw;
+    unsigned long long frames = 0, rawBytes = 0, storedBytes = 0;
+    FrameReadResult result;
+
+    while ((result = ReadFrame(file, header, raw)) == kFrameOk) {
+        frames++;
+        rawBytes += header.rawSize;
+        storedBytes += header.storedSize + kFrameHeaderSize;
+        if (!statsOnly) std::fwrite(raw.data(), 1, raw.size(), stdout);
+    }
+
+    std::fclose(file);
+
+    if (result == kFrameTruncated) {
+        std::fprintf(stderr, "kazik_cat: %s: truncated after frame %llu (run was cut off)\n", path, frames);
+    }
+    else if (result == kFrameCorrupt) {
+        std::fprintf(stderr, "kazik_cat: %s: corrupt frame %llu\n", path, frames + 1);
+    }
+
+    if (statsOnly) {
+        std::fprintf(stderr, "%s: %llu frames, %llu raw bytes, %llu stored bytes (%.2fx)\n",
+            path, frames, rawBytes, storedBytes,
+            storedBytes ? static_cast<double>(rawBytes) / storedBytes : 0.0);
+    }
+
+    return result == kFrameCorrupt ? 2 : 0;
+}
+
+int main(int argc, char** argv) {
+    bool statsOnly = false;
+    int status = 0;
+    int files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-s") == 0) {
+            statsOnly = true;
+            continue;
+        }
+        status |= CatFile(argv[i], statsOnly);
+        files++;
+    }
+
+    if (files == 0) {
+        std::fprintf(stderr, "usage: kazik_cat [-s] <file.kzf>...\n");
+        return 1;
+    }
+
+    return status;
+}
@@ -0,0 +1,180 @@
+// Self-check for the KZF frame codec in Main/Code/frame_codec.h.
+//
+// Build: g++ -std=c++17 -O2 -IMain/Code Tools/kazik_frame_check.cpp -o kazik_frame_check
+// Usage: kazik_frame_check [seed]
+//   Exits 0 when every check passes; prints each failure and exits 1.
+//
+// Covers LZ4 round trips at every level on random, repetitive and mixed
+// input, decoding of truncated and randomly damaged blocks, and frame
+// streams cut off at every byte of their last frame.
+
+#include "frame_codec.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+
+static void Check(bool condition, const std::string& what) {
+    if (condition) return;
+    g_failures++;
+    std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+}
+
+// Random bytes, long repeats, or runs of text-like symbols with back
+// references, so both the literal and the match paths are exercised.
+static std::vector<uint8_t> MakeInput(std::mt19937& rng, size_t size, int shape) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        switch (shape) {
+        case 0: data[i] = static_cast<uint8_t>(rng()); break;
+        case 1: data[i] = static_cast<uint8_t>("abcab"[i % 5]); break;
+        default:
+            if (i >= 64 && rng() % 4 == 0) {
+                data[i] = data[i - 1 - rng() % 64];
+            }
+            else {
+                data[i] = static_cast<uint8_t>('a' + rng() % 12);
+            }
+            break;
+        }
+    }
+    return data;
+}
+
+static void CheckRoundTrips(std::mt19937& rng) {
+    const size_t sizes[] = { 0, 1, 5, 12, 13, 17, 255, 4096, 65536, 65536 + 777, 300000 };
+    for (size_t size : sizes) {
+        for (int shape = 0; shape < 3; shape++) {
+            std::vector<uint8_t> raw = MakeInput(rng, size, shape);
+            for (int level = 1; level <= 9; level += 4) {
+                std::vector<uint8_t> packed(Lz4CompressBound(size));
+                size_t packedSize = Lz4CompressBlock(raw.data(), raw.size(), packed.data(), packed.size(), level);
+                std::string label = "size " + std::to_string(size) + " shape " + std::to_string(shape) +
+                    " level " + std::to_string(level);
+                Check(packedSize > 0 && packedSize <= packed.size(), "compress " + label);
+
+                std::vector<uint8_t> restored(size);
+                Check(Lz4DecompressBlock(packed.data(), packedSize, restored.data(), restored.size()) &&
+                    restored == raw, "round trip " + label);
+
+                // A block cut short must be rejected, never decoded into
+                // something else.
+                for (size_t cut = 0; cut < packedSize; cut += 1 + packedSize / 64) {
+                    std::vector<uint8_t> partial(size);
+                    bool ok = Lz4DecompressBlock(packed.data(), cut, partial.data(), partial.size());
+                    Check(!ok || partial == raw, "truncated block at " + std::to_string(cut) + ", " + label);
+                }
+            }
+        }
+    }
+}
+
+// Damaged and random blocks may decode or fail, but must stay inside their
+// buffers; build with -fsanitize=address to make overruns fatal.
+static void CheckDamagedBlocks(std::mt19937& rng) {
+    for (int round = 0; round < 2000; round++) {
+        size_t size = 1 + rng() % 8192;
+        std::vector<uint8_t> raw = MakeInput(rng, size, round % 3);
+        std::vector<uint8_t> packed(Lz4CompressBound(size));
+        packed.resize(Lz4CompressBlock(raw.data(), raw.size(), packed.data(), packed.size(), 1 + round % 9));
+
+        int flips = 1 + rng() % 4;
+        for (int i = 0; i < flips; i++) {
+            packed[rng() % packed.size()] ^= static_cast<uint8_t>(1 + rng() % 255);
+        }
+        std::vector<uint8_t> out(size);
+        Lz4DecompressBlock(packed.data(), packed.size(), out.data(), out.size());
+
+        std::vector<uint8_t> noise = MakeInput(rng, 1 + rng() % 512, 0);
+        Lz4DecompressBlock(noise.data(), noise.size(), out.data(), out.size());
+    }
+}
+
+static void CheckFrameStream(std::mt19937& rng) {
+    const char* path = "kazik_frame_check.kzf";
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint8_t> stream;
+    std::vector<size_t> frameEnds;
+    for (int i = 0; i < 4; i++) {
+        frames.push_back(MakeInput(rng, 1000 + rng() % 60000, i % 3));
+        EncodeFrame(frames.back().data(), frames.back().size(), kCodecLz4, 1 + i, stream);
+        frameEnds.push_back(stream.size());
+    }
+
+    auto writeFile = [&](size_t bytes) {
+        std::FILE* file = std::fopen(path, "wb");
+        if (!file) return false;
+        std::fwrite(stream.data(), 1, bytes, file);
+        std::fclose(file);
+        return true;
+    };
+
+    // Cut inside the last frame: the first three decode, the fourth reports
+    // a truncation, and the valid prefix ends exactly after frame three.
+    size_t lastStart = frameEnds[2];
+    for (size_t cut = lastStart; cut <= stream.size(); cut += (cut - lastStart < 64 ? 1 : 997)) {
+        if (!writeFile(cut)) {
+            Check(false, "cannot write " + std::string(path));
+            return;
+        }
+
+        std::FILE* file = std::fopen(path, "rb");
+        FrameHeader header;
+        std::vector<uint8_t> raw;
+        size_t decoded = 0;
+        FrameReadResult result;
+        while ((result = ReadFrame(file, header, raw)) == kFrameOk) {
+            Check(decoded < frames.size() && raw == frames[decoded], "frame " + std::to_string(decoded) + " content");
+            decoded++;
+        }
+        bool complete = cut == stream.size();
+        Check(decoded == (complete ? 4u : 3u), "frames decoded with cut at " + std::to_string(cut));
+        Check(result == (complete || cut == lastStart ? kFrameEnd : kFrameTruncated),
+            "read result with cut at " + std::to_string(cut));
+
+        std::rewind(file);
+        uint64_t goodBytes = 0;
+        uint64_t rawSize = FrameStreamValidPrefix(file, goodBytes);
+        std::fclose(file);
+
+        size_t expectedFrames = complete ? 4 : 3;
+        uint64_t expectedRaw = 0;
+        for (size_t i = 0; i < expectedFrames; i++) expectedRaw += frames[i].size();
+        Check(goodBytes == frameEnds[expectedFrames - 1] && rawSize == expectedRaw,
+            "valid prefix with cut at " + std::to_string(cut));
+    }
+
+    // A damaged payload byte is caught by the checksum or the decoder.
+    std::vector<uint8_t> damaged = stream;
+    damaged[frameEnds[0] + kFrameHeaderSize + 10] ^= 0x5A;
+    std::FILE* file = std::fopen(path, "wb");
+    std::fwrite(damaged.data(), 1, damaged.size(), file);
+    std::fclose(file);
+    file = std::fopen(path, "rb");
+    FrameHeader header;
+    std::vector<uint8_t> raw;
+    Check(ReadFrame(file, header, raw) == kFrameOk, "frame before the damaged one");
+    Check(ReadFrame(file, header, raw) == kFrameCorrupt, "damaged frame is rejected");
+    std::fclose(file);
+    std::remove(path);
+}
+
+int main(int argc, char** argv) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    std::mt19937 rng(seed);
+
+    CheckRoundTrips(rng);
+    CheckDamagedBlocks(rng);
+    CheckFrameStream(rng);
+
+    if (g_failures) {
+        std::fprintf(stderr, "kazik_frame_check: %d failures (seed %u)\n", g_failures, seed);
+        return 1;
+    }
+    std::printf("kazik_frame_check: ok (seed %u)\n", seed);
+    return 0;
+}
@@ -0,0 +1,214 @@
+// Self-check for the KZI index in Main/Code/dump_index.h.
+//
+// Build: g++ -std=c++17 -O2 -IMain/Code Tools/kazik_index_check.cpp -o kazik_index_check
+// Usage: kazik_index_check [seed]
+//   Exits 0 when every check passes; prints each failure and exits 1.
+//
+// Writes an index of generated classes and methods, answers exact, prefix,
+// bare-method and address-range lookups through DumpIndexView and compares
+// each with a linear scan of the records, then checks that truncated and
+// damaged index files are refused by Open.
+
+#include "dump_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+static int g_failures = 0;
+
+static void Check(bool condition, const std::string& what) {
+    if (condition) return;
+    g_failures++;
+    std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+}
+
+using Match = std::pair<std::string, uint64_t>;
+
+static std::vector<DumpIndexRecord> MakeRecords(std::mt19937& rng) {
+    static const char* const kNamespaces[] = { "", "Game", "Game::UI", "UnityEngine", "System::Collections" };
+    static const char* const kMethods[] = { "Update", "Awake", "get_Health", "set_Health", "OnDestroy", "Init" };
+
+    std::vector<DumpIndexRecord> records;
+    for (int c = 0; c < 400; c++) {
+        std::string nameSpace = kNamespaces[rng() % 5];
+        std::string className = (nameSpace.empty() ? "" : nameSpace + "::") + "Class" + std::to_string(rng() % 300);
+        uint64_t classAddress = 0x7FF600000000ull + (rng() % 100000) * 0x100;
+
+        DumpIndexRecord record;
+        record.name = className;
+        record.shortStart = 0;
+        record.kind = kIndexClass;
+        record.address = classAddress;
+        record.dumpOffset = static_cast<uint64_t>(c) * 4096;
+        records.push_back(record);
+
+        int methods = static_cast<int>(rng() % 5);
+        for (int m = 0; m < methods; m++) {
+            record.name = className + "::" + kMethods[rng() % 6];
+            record.shortStart = static_cast<uint16_t>(className.size() + 2);
+            record.kind = kIndexMethod;
+            record.address = rng() % 8 ? 0x7FFA00000000ull + (rng() % 50000) * 0x10 : 0;
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+static std::vector<Match> Sorted(std::vector<Match> matches) {
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+static void CheckLookups(const DumpIndexView& index, const std::vector<DumpIndexRecord>& records, std::mt19937& rng) {
+    auto collect = [&](std::vector<Match>& out) {
+        return [&](const DumpIndexEntry& entry) { out.emplace_back(std::string(index.Name(entry)), entry.address); };
+    };
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 200; i++) keys.push_back(records[rng() % records.size()].name);
+    keys.push_back("Missing::Class");
+    keys.push_back("");
+    keys.push_back("Game::UI::Class1");
+    keys.push_back("Game::UI::Class");
+    keys.push_back("System");
+
+    for (const std::string& key : keys) {
+        for (int prefix = 0; prefix < 2; prefix++) {
+            std::vector<Match> expected;
+            for (const auto& record : records) {
+                bool match = prefix ? record.name.compare(0, key.size(), key) == 0 : record.name == key;
+                if (match) expected.emplace_back(record.name, record.address);
+            }
+            std::vector<Match> found;
+            size_t count = index.FindByName(key, prefix != 0, false, collect(found));
+            Check(count == found.size() && Sorted(found) == Sorted(expected),
+                std::string(prefix ? "prefix" : "exact") + " lookup of \"" + key + "\"");
+        }
+    }
+
+    const char* const shortKeys[] = { "Update", "get_", "set_Health", "Awake", "Missing", "" };
+    for (const char* key : shortKeys) {
+        for (int prefix = 0; prefix < 2; prefix++) {
+            std::string_view keyView(key);
+            std::vector<Match> expected;
+            for (const auto& record : records) {
+                if (record.kind != kIndexMethod) continue;
+                std::string_view bare = std::string_view(record.name).substr(record.shortStart);
+                bool match = prefix ? bare.substr(0, keyView.size()) == keyView : bare == keyView;
+                if (match) expected.emplace_back(record.name, record.address);
+            }
+            std::vector<Match> found;
+            index.FindByName(keyView, prefix != 0, true, collect(found));
+            Check(Sorted(found) == Sorted(expected), std::string("method ") + (prefix ? "prefix" : "exact") +
+                " lookup of \"" + key + "\"");
+        }
+    }
+
+    for (int i = 0; i < 200; i++) {
+        uint64_t a = records[rng() % records.size()].address + (rng() % 3) - 1;
+        uint64_t b = a + (rng() % 4 ? rng() % 0x100000 : 0);
+        std::vector<Match> expected;
+        for (const auto& record : records) {
+            if (record.address >= a && record.address <= b) expected.emplace_back(record.name, record.address);
+        }
+        std::vector<Match> found;
+        index.FindByAddress(a, b, collect(found));
+        bool ordered = std::is_sorted(found.begin(), found.end(), [](const Match& x, const Match& y) {
+            return x.second < y.second;
+        });
+        Check(ordered && Sorted(found) == Sorted(expected), "range lookup " + std::to_string(a) + ".." + std::to_string(b));
+    }
+}
+
+static std::vector<uint8_t> ReadAll(const char* path) {
+    std::vector<uint8_t> bytes;
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return bytes;
+    uint8_t chunk[4096];
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) bytes.insert(bytes.end(), chunk, chunk + got);
+    std::fclose(file);
+    return bytes;
+}
+
+static bool OpensAs(const char* path, const std::vector<uint8_t>& bytes) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+    DumpIndexView view;
+    return view.Open(path);
+}
+
+static void CheckDamagedIndexes(const char* path, std::mt19937& rng) {
+    const std::vector<uint8_t> good = ReadAll(path);
+    const char* damagedPath = "kazik_index_check_damaged.kzi";
+    Check(OpensAs(damagedPath, good), "a byte-for-byte copy opens");
+
+    for (size_t cut = 1; cut < good.size(); cut += 1 + good.size() / 97) {
+        Check(!OpensAs(damagedPath, std::vector<uint8_t>(good.begin(), good.begin() + cut)),
+            "index truncated to " + std::to_string(cut) + " bytes is refused");
+    }
+
+    DumpIndexHeader header;
+    std::memcpy(&header, good.data(), sizeof(header));
+    auto withHeader = [&](auto&& edit) {
+        std::vector<uint8_t> bytes = good;
+        DumpIndexHeader changed = header;
+        edit(changed);
+        std::memcpy(bytes.data(), &changed, sizeof(changed));
+        return bytes;
+    };
+    Check(!OpensAs(damagedPath, withHeader([](DumpIndexHeader& h) { h.magic ^= 1; })), "bad magic is refused");
+    Check(!OpensAs(damagedPath, withHeader([](DumpIndexHeader& h) { h.entryCount += 1000; })), "oversized entry count is refused");
+    Check(!OpensAs(damagedPath, withHeader([](DumpIndexHeader& h) { h.shortCount = h.entryCount + 1; })), "short count above entry count is refused");
+    Check(!OpensAs(damagedPath, withHeader([](DumpIndexHeader& h) { h.byNameOffset += 2; })), "misaligned table is refused");
+    Check(!OpensAs(damagedPath, withHeader([](DumpIndexHeader& h) { h.stringsSize += 1; })), "strings past the end are refused");
+
+    for (int i = 0; i < 50; i++) {
+        std::vector<uint8_t> bytes = good;
+        uint32_t entry = static_cast<uint32_t>(rng() % header.entryCount);
+        DumpIndexEntry* entries = reinterpret_cast<DumpIndexEntry*>(bytes.data() + header.entriesOffset);
+        switch (i % 3) {
+        case 0: entries[entry].nameOffset = static_cast<uint32_t>(header.stringsSize); entries[entry].nameLength = 1; break;
+        case 1: entries[entry].shortStart = static_cast<uint16_t>(entries[entry].nameLength + 1); break;
+        default: reinterpret_cast<uint32_t*>(bytes.data() + header.byAddressOffset)[entry] = header.entryCount; break;
+        }
+        Check(!OpensAs(damagedPath, bytes), "damaged entry " + std::to_string(entry) + " is refused");
+    }
+    std::remove(damagedPath);
+}
+
+int main(int argc, char** argv) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    std::mt19937 rng(seed);
+    const char* path = "kazik_index_check.kzi";
+
+    std::vector<DumpIndexRecord> records = MakeRecords(rng);
+    Check(WriteDumpIndex(path, "Kitay_Kazik_total_dump.txt", records), "write index");
+
+    DumpIndexView index;
+    if (!index.Open(path)) {
+        Check(false, "open written index");
+    }
+    else {
+        Check(index.header->entryCount == records.size(), "entry count");
+        CheckLookups(index, records, rng);
+        index.Close();
+        CheckDamagedIndexes(path, rng);
+    }
+    std::remove(path);
+
+    if (g_failures) {
+        std::fprintf(stderr, "kazik_index_check: %d failures (seed %u)\n", g_failures, seed);
+        return 1;
+    }
+    std::printf("kazik_index_check: ok (seed %u, %zu records)\n", seed, records.size());
+    return 0;
+}
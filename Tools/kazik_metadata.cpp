@@ -0,0 +1,141 @@
+// Builds the class catalog straight from global-metadata.dat, no game needed.
+// Writes the same total dump and KZI index as a live run, with metadata
+// tokens in place of runtime addresses.
+//
+// Build: g++ -std=c++17 -O2 -pthread -IMain/Code Tools/kazik_metadata.cpp -o kazik_metadata
+// Usage: kazik_metadata [-o <dir>] [-j <workers>] [-z <level>] <global-metadata.dat>
+//   -o  output directory (default: current directory)
+//   -j  decode threads (default: hardware threads)
+//   -z  write Kitay_Kazik_total_dump.txt.kzf at this LZ4 level (1 greedy, 2-9 hash chain)
+
+#include "dump_index.h"
+#include "frame_codec.h"
+#include "metadata_parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plain or KZF output; offsets are always in the uncompressed stream.
+struct DumpWriter {
+    std::FILE* file = nullptr;
+    int level = 0;
+    uint64_t offset = 0;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> frame;
+
+    uint64_t Write(const std::string& text) {
+        uint64_t start = offset;
+        offset += text.size();
+        if (level == 0) {
+            std::fwrite(text.data(), 1, text.size(), file);
+            return start;
+        }
+
+        buffer.insert(buffer.end(), text.begin(), text.end());
+        if (buffer.size() >= 256 * 1024) Flush();
+        return start;
+    }
+
+    void Flush() {
+        if (level == 0 || buffer.empty()) return;
+        frame.clear();
+        EncodeFrame(buffer.data(), buffer.size(), kCodecLz4, level, frame);
+        std::fwrite(frame.data(), 1, frame.size(), file);
+        buffer.clear();
+    }
+};
+
+int main(int argc, char** argv) {
+    std::string outDir = ".";
+    int workers = static_cast<int>(std::thread::hardware_concurrency());
+    int level = 0;
+    const char* metadataPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            workers = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "-z") == 0 && i + 1 < argc) {
+            level = std::atoi(argv[++i]);
+        }
+        else {
+            metadataPath = argv[i];
+        }
+    }
+
+    if (!metadataPath) {
+        std::fprintf(stderr, "usage: kazik_metadata [-o <dir>] [-j <workers>] [-z <level>] <global-metadata.dat>\n");
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    MetadataFile metadata;
+    std::string error;
+    if (!metadata.Open(metadataPath, error)) {
+        std::fprintf(stderr, "kazik_metadata: %s: %s\n", metadataPath, error.c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr, "%s: version %d (layout %s), %u types, %u fields, %u methods\n", metadataPath,
+        metadata.version, metadata.layout->name, metadata.typeCount, metadata.fieldCount, metadata.methodCount);
+
+    std::string dumpName = level > 0 ? "Kitay_Kazik_total_dump.txt.kzf" : "Kitay_Kazik_total_dump.txt";
+    DumpWriter dump;
+    dump.level = level;
+    dump.file = std::fopen((outDir + "/" + dumpName).c_str(), "wb");
+    if (!dump.file) {
+        std::fprintf(stderr, "kazik_metadata: cannot write %s/%s\n", outDir.c_str(), dumpName.c_str());
+        return 1;
+    }
+
+    std::vector<DumpIndexRecord> records;
+    int classNumber = 0;
+    std::string block;
+
+    size_t classes = ParseMetadataClasses(metadata, (std::max)(1, workers), [&](const MetadataClass& cls) {
+        std::string fullName = cls.FullName();
+        char header[64];
+        std::snprintf(header, sizeof(header), " [token: 0x%08x]\n", cls.token);
+
+        block = "[CLASS " + std::to_string(++classNumber) + "] " + fullName + header;
+        block += "  Fields (" + std::to_string(cls.fields.size()) + "):\n";
+        for (const auto& field : cls.fields) {
+            block += "    " + MetadataFieldLine(field) + "\n";
+        }
+        block += "  Methods (" + std::to_string(cls.methods.size()) + "):\n";
+        for (const auto& method : cls.methods) {
+            block += "    " + MetadataMethodLine(method) + "\n";
+        }
+        block += "\n\n";
+
+        uint64_t offset = dump.Write(block);
+        records.push_back({ fullName, 0, kIndexClass, cls.token, offset });
+        for (const auto& method : cls.methods) {
+            records.push_back({ fullName + "::" + std::string(method.name),
+                static_cast<uint16_t>(fullName.size() + 2), kIndexMethod, method.token, offset });
+        }
+    });
+
+    dump.Flush();
+    std::fclose(dump.file);
+
+    std::string indexPath = outDir + "/Kitay_Kazik_dump_index.kzi";
+    if (!WriteDumpIndex(indexPath, dumpName, records)) {
+        std::fprintf(stderr, "kazik_metadata: cannot write %s\n", indexPath.c_str());
+        return 1;
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::fprintf(stderr, "%zu classes, %zu index entries, %llu dump bytes in %.1f ms\n", classes, records.size(),
+        static_cast<unsigned long long>(dump.offset), elapsedMs);
+    return 0;
+}
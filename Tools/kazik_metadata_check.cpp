@@ -0,0 +1,215 @@
+// Self-check for the global-metadata.dat reader in Main/Code/metadata_parser.h.
+//
+// Build: g++ -std=c++17 -O2 -pthread -IMain/Code Tools/kazik_metadata_check.cpp -o kazik_metadata_check
+// Usage: kazik_metadata_check
+//   Exits 0 when every check passes; prints each failure and exits 1.
+//
+// Generates one metadata file per supported record layout, opens it, checks
+// that the right layout is detected, and compares every class, field and
+// method ParseMetadataClasses returns with what was written. Also checks
+// that bad sanity, sections past the end and unsupported versions are
+// refused.
+
+#include "metadata_parser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+
+static void Check(bool condition, const std::string& what) {
+    if (condition) return;
+    g_failures++;
+    std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+}
+
+static void Put32(std::vector<uint8_t>& bytes, size_t offset, uint32_t value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+static void Put16(std::vector<uint8_t>& bytes, size_t offset, uint16_t value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+// The generated type t has t % 5 fields and t % 7 methods; every third
+// type has no namespace.
+static std::string ClassName(uint32_t t) { return "Class" + std::to_string(t); }
+static std::string NamespaceName(uint32_t t) { return t % 3 ? "Game.Ns" + std::to_string(t % 10) : ""; }
+static std::string FieldName(uint32_t t, uint32_t f) { return "field_" + std::to_string(t) + "_" + std::to_string(f); }
+static std::string MethodName(uint32_t t, uint32_t m) { return "Method" + std::to_string(t) + "_" + std::to_string(m); }
+
+static std::vector<uint8_t> BuildMetadata(const MetadataLayout& layout, int version, uint32_t typeCount) {
+    std::string strings(1, '\0');
+    auto addString = [&](const std::string& text) {
+        uint32_t index = static_cast<uint32_t>(strings.size());
+        strings += text;
+        strings += '\0';
+        return index;
+    };
+
+    std::vector<uint8_t> types, fields, methods;
+    uint32_t fieldIndex = 0, methodIndex = 0;
+    for (uint32_t t = 0; t < typeCount; t++) {
+        uint32_t fieldTotal = t % 5, methodTotal = t % 7;
+        size_t base = types.size();
+        types.resize(base + layout.typeSize);
+        uint32_t flagsAt = layout.typeFlagsSlot * 4;
+        uint32_t countsAt = (layout.typeFlagsSlot + 9) * 4;
+        Put32(types, base, addString(ClassName(t)));
+        Put32(types, base + 4, addString(NamespaceName(t)));
+        Put32(types, base + flagsAt, 0x100001);
+        Put32(types, base + flagsAt + 4, fieldTotal ? fieldIndex : 0xFFFFFFFF);
+        Put32(types, base + flagsAt + 8, methodTotal ? methodIndex : 0xFFFFFFFF);
+        Put16(types, base + countsAt, static_cast<uint16_t>(methodTotal));
+        Put16(types, base + countsAt + 4, static_cast<uint16_t>(fieldTotal));
+        Put32(types, base + countsAt + 20, 0x02000001 + t);
+
+        for (uint32_t f = 0; f < fieldTotal; f++, fieldIndex++) {
+            size_t at = fields.size();
+            fields.resize(at + layout.fieldSize);
+            Put32(fields, at, addString(FieldName(t, f)));
+            Put32(fields, at + 4, 7);
+            Put32(fields, at + layout.fieldSize - 4, 0x04000001 + fieldIndex);
+        }
+        for (uint32_t m = 0; m < methodTotal; m++, methodIndex++) {
+            size_t at = methods.size();
+            methods.resize(at + layout.methodSize);
+            Put32(methods, at, addString(MethodName(t, m)));
+            Put32(methods, at + layout.methodSize - 12, 0x06000001 + methodIndex);
+            Put16(methods, at + layout.methodSize - 8, 6);
+            Put16(methods, at + layout.methodSize - 2, static_cast<uint16_t>(m));
+        }
+    }
+
+    constexpr size_t kPairs = 30;
+    std::vector<uint8_t> file(8 + kPairs * 8, 0);
+    Put32(file, 0, kMetadataSanity);
+    Put32(file, 4, static_cast<uint32_t>(version));
+    auto addSection = [&](int index, const void* data, size_t size) {
+        size_t offset = file.size();
+        file.insert(file.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        while (file.size() % 4) file.push_back(0);
+        Put32(file, 8 + size_t(index) * 8, static_cast<uint32_t>(offset));
+        Put32(file, 8 + size_t(index) * 8 + 4, static_cast<uint32_t>(size));
+    };
+    addSection(kSectionStrings, strings.data(), strings.size());
+    addSection(kSectionMethods, methods.data(), methods.size());
+    addSection(kSectionFields, fields.data(), fields.size());
+    addSection(kSectionTypeDefinitions, types.data(), types.size());
+    return file;
+}
+
+static bool WriteFile(const char* path, const std::vector<uint8_t>& bytes) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+static void CheckClass(const MetadataClass& cls, uint32_t& fieldIndex, uint32_t& methodIndex, const std::string& label) {
+    uint32_t t = cls.index;
+    std::string where = label + " type " + std::to_string(t);
+    Check(cls.name == ClassName(t) && cls.nameSpace == NamespaceName(t), where + " name");
+    Check(cls.token == 0x02000001 + t && cls.flags == 0x100001, where + " token and flags");
+    Check(cls.FullName() == (NamespaceName(t).empty() ? ClassName(t) : NamespaceName(t) + "::" + ClassName(t)),
+        where + " full name");
+
+    bool fieldsOk = cls.fields.size() == t % 5;
+    for (uint32_t f = 0; fieldsOk && f < cls.fields.size(); f++, fieldIndex++) {
+        const MetadataField& field = cls.fields[f];
+        fieldsOk = field.name == FieldName(t, f) && field.typeIndex == 7 && field.token == 0x04000001 + fieldIndex;
+    }
+    Check(fieldsOk, where + " fields");
+
+    bool methodsOk = cls.methods.size() == t % 7;
+    for (uint32_t m = 0; methodsOk && m < cls.methods.size(); m++, methodIndex++) {
+        const MetadataMethod& method = cls.methods[m];
+        methodsOk = method.name == MethodName(t, m) && method.token == 0x06000001 + methodIndex &&
+            method.flags == 6 && method.parameterCount == m;
+    }
+    Check(methodsOk, where + " methods");
+}
+
+static void CheckLayout(const MetadataLayout& layout, int version, uint32_t typeCount, int workers) {
+    const char* path = "kazik_metadata_check.dat";
+    std::string label = std::string("layout ") + layout.name + " v" + std::to_string(version) + " (" +
+        std::to_string(typeCount) + " types, " + std::to_string(workers) + " workers)";
+    if (!WriteFile(path, BuildMetadata(layout, version, typeCount))) {
+        Check(false, "cannot write " + std::string(path));
+        return;
+    }
+
+    MetadataFile metadata;
+    std::string error;
+    if (!metadata.Open(path, error)) {
+        Check(false, label + " open: " + error);
+        std::remove(path);
+        return;
+    }
+    Check(metadata.version == version, label + " version");
+    Check(std::strcmp(metadata.layout->name, layout.name) == 0,
+        label + " detected as " + metadata.layout->name);
+    Check(metadata.typeCount == typeCount, label + " type count");
+
+    uint32_t expected = 0, fieldIndex = 0, methodIndex = 0;
+    size_t emitted = ParseMetadataClasses(metadata, workers, [&](const MetadataClass& cls) {
+        Check(cls.index == expected, label + " classes in type order");
+        expected = cls.index + 1;
+        CheckClass(cls, fieldIndex, methodIndex, label);
+    });
+    Check(emitted == typeCount, label + " classes emitted");
+
+    metadata.file.Close();
+    std::remove(path);
+}
+
+static void CheckRejected(const char* what, std::vector<uint8_t> bytes, const char* expectedError) {
+    const char* path = "kazik_metadata_check_bad.dat";
+    WriteFile(path, bytes);
+    MetadataFile metadata;
+    std::string error;
+    bool opened = metadata.Open(path, error);
+    Check(!opened && error.find(expectedError) != std::string::npos,
+        std::string(what) + " is refused (got \"" + error + "\")");
+    metadata.file.Close();
+    std::remove(path);
+}
+
+int main() {
+    for (const auto& layout : kMetadataLayouts) {
+        for (int version = layout.minVersion; version <= layout.maxVersion; version++) {
+            CheckLayout(layout, version, 3000, 4);
+        }
+        CheckLayout(layout, layout.minVersion, 7, 1);
+    }
+
+    std::vector<uint8_t> good = BuildMetadata(kMetadataLayouts[0], 24, 100);
+    std::vector<uint8_t> bytes = good;
+    Put32(bytes, 0, 0x12345678);
+    CheckRejected("bad sanity", bytes, "bad sanity");
+
+    bytes = good;
+    Put32(bytes, 8 + kSectionTypeDefinitions * 8 + 4, static_cast<uint32_t>(good.size()));
+    CheckRejected("type table past the end", bytes, "outside the file");
+
+    bytes = good;
+    Put32(bytes, 4, 23);
+    CheckRejected("version 23", bytes, "unsupported");
+
+    bytes = good;
+    Put32(bytes, 4, 30);
+    CheckRejected("version 30", bytes, "unsupported");
+
+    CheckRejected("truncated header", std::vector<uint8_t>(good.begin(), good.begin() + 64), "bad sanity");
+
+    if (g_failures) {
+        std::fprintf(stderr, "kazik_metadata_check: %d failures\n", g_failures);
+        return 1;
+    }
+    std::printf("kazik_metadata_check: ok (%zu layouts)\n", sizeof(kMetadataLayouts) / sizeof(kMetadataLayouts[0]));
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Looks up classes and methods in a KZI index written by the dumper, or asks
+// a running dumper over its query endpoint (enableQueryServer).
+//
+// Build: g++ -std=c++17 -O2 -pthread -IMain/Code Tools/kazik_query.cpp -o kazik_query
+// Usage: kazik_query <index.kzi> exact <Namespace::Class[::Method]>
+//        kazik_query <index.kzi> prefix <name prefix>
+//        kazik_query <index.kzi> method <bare method name>
+//        kazik_query <index.kzi> range <lo> <hi>
+//        kazik_query <index.kzi> serve <endpoint>
+//        kazik_query --live <endpoint> name <text> | addr <address> | range <lo> <hi> | stats | watch
+//   --dump <file>  also print the class block each hit points to (.txt or .kzf)
+//   serve          answer the live protocol from the index until interrupted,
+//                  so clients can be tested without the game
+
+#include "dump_index.h"
+#include "frame_codec.h"
+#include "query_server.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Prints the class block starting at offset: everything up to the first
+// blank line. Compressed dumps are decoded frame by frame up to the offset.
+// Plain dumps written on Windows end their lines in \r\n; both forms end
+// a block, and the \r is dropped from the output.
+static void PrintDumpBlock(const char* dumpPath, uint64_t offset) {
+    std::FILE* file = std::fopen(dumpPath, "rb");
+    if (!file) {
+        std::fprintf(stderr, "kazik_query: cannot open %s\n", dumpPath);
+        return;
+    }
+
+    std::string block;
+    size_t pathLength = std::strlen(dumpPath);
+    bool compressed = pathLength > 4 && std::strcmp(dumpPath + pathLength - 4, ".kzf") == 0;
+
+    auto consume = [&](const uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            if (data[i] == '\r') continue;
+            block.push_back(static_cast<char>(data[i]));
+            size_t n = block.size();
+            if (n >= 2 && block[n - 1] == '\n' && block[n - 2] == '\n') return true;
+        }
+        return false;
+    };
+
+    if (compressed) {
+        FrameHeader header;
+        std::vector<uint8_t> raw;
+        uint64_t position = 0;
+        while (ReadFrame(file, header, raw) == kFrameOk) {
+            uint64_t frameEnd = position + raw.size();
+            if (frameEnd > offset) {
+                size_t skip = offset > position ? static_cast<size_t>(offset - position) : 0;
+                if (consume(raw.data() + skip, raw.size() - skip)) break;
+            }
+            position = frameEnd;
+        }
+    }
+    else if (std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0) {
+        uint8_t buffer[4096];
+        size_t got;
+        while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0 && !consume(buffer, got)) {
+        }
+    }
+
+    std::fclose(file);
+    std::fwrite(block.data(), 1, block.size(), stdout);
+}
+
+// Sends one request to a live endpoint and copies the reply to stdout.
+static int QueryLive(const char* endpoint, const std::vector<const char*>& args) {
+    std::string request;
+    for (const char* arg : args) {
+        if (!request.empty()) request += ' ';
+        request += arg;
+    }
+
+    QueryChannel channel;
+    if (!channel.Connect(endpoint)) {
+        std::fprintf(stderr, "kazik_query: nothing listening on %s\n", QueryEndpointPath(endpoint).c_str());
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    if (!channel.Write(request + "\n")) return 1;
+
+    std::string line;
+    while (channel.ReadLine(line)) {
+        if (line.size() >= 2 && line[0] == '.' && line[1] == ' ') {
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+            std::fprintf(stderr, "%s hit(s) in %.3f ms\n", line.c_str() + 2, elapsedMs);
+            return line == ". 0" ? 2 : 0;
+        }
+        std::printf("%s\n", line.c_str());
+        std::fflush(stdout);
+    }
+    return 0;
+}
+
+static std::atomic<bool> g_interrupted{ false };
+
+// Serves index entries over the live protocol; watch clients never see a record.
+static int ServeIndex(const DumpIndexView& index, const char* endpoint) {
+    QueryServer server;
+    bool started = server.Start(endpoint, [&](const QueryRequest& request, QueryChannel& channel) {
+        std::string reply;
+        size_t count = 0;
+        auto emit = [&](const DumpIndexEntry& entry) {
+            LineBuffer line;
+            QueryRecordLine(line, DumpIndexKindName(entry.kind), entry.address, index.Name(entry), {});
+            reply.append(line.data, line.size);
+            count++;
+        };
+
+        if (request.kind == kQueryName) {
+            for (uint32_t i = 0; i < index.header->entryCount; i++) {
+                if (index.Name(index.entries[i]).find(request.text) != std::string_view::npos) emit(index.entries[i]);
+            }
+        }
+        else if (request.kind == kQueryAddress || request.kind == kQueryRange) {
+            index.FindByAddress(request.lo, request.hi, emit);
+        }
+        else if (request.kind == kQueryStats) {
+            LineBuffer line;
+            line << "entries " << index.header->entryCount << "\ncomplete 1\n";
+            reply.append(line.data, line.size);
+            count = 2;
+        }
+
+        channel.Write(reply);
+        return count;
+    });
+
+    if (!started) {
+        std::fprintf(stderr, "kazik_query: cannot listen on %s\n", QueryEndpointPath(endpoint).c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr, "serving %u entries on %s\n", index.header->entryCount, server.path.c_str());
+    std::signal(SIGINT, [](int) { g_interrupted = true; });
+    std::signal(SIGTERM, [](int) { g_interrupted = true; });
+    while (!g_interrupted) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    server.Stop();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* dumpPath = nullptr;
+    const char* liveEndpoint = nullptr;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--live") == 0 && i + 1 < argc) {
+            liveEndpoint = argv[++i];
+        }
+        else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (liveEndpoint && !args.empty()) {
+        return QueryLive(liveEndpoint, args);
+    }
+
+    if (args.size() < 3) {
+        std::fprintf(stderr, "usage: kazik_query <index.kzi> exact|prefix|method <name> | range <lo> <hi> [--dump <file>]\n"
+            "       kazik_query <index.kzi> serve <endpoint>\n"
+            "       kazik_query --live <endpoint> name <text> | addr <address> | range <lo> <hi> | stats | watch\n");
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    DumpIndexView index;
+    if (!index.Open(args[0])) {
+        std::fprintf(stderr, "kazik_query: %s is not a readable index\n", args[0]);
+        return 1;
+    }
+
+    std::vector<DumpIndexEntry> hits;
+    auto collect = [&](const DumpIndexEntry& entry) { hits.push_back(entry); };
+
+    std::string mode = args[1];
+    if (mode == "serve") {
+        return ServeIndex(index, args[2]);
+    }
+    else if (mode == "exact") {
+        index.FindByName(args[2], false, false, collect);
+    }
+    else if (mode == "prefix") {
+        index.FindByName(args[2], true, false, collect);
+    }
+    else if (mode == "method") {
+        index.FindByName(args[2], false, true, collect);
+    }
+    else if (mode == "range" && args.size() >= 4) {
+        index.FindByAddress(std::strtoull(args[2], nullptr, 0), std::strtoull(args[3], nullptr, 0), collect);
+    }
+    else {
+        std::fprintf(stderr, "kazik_query: unknown query '%s'\n", args[1]);
+        return 1;
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    for (const auto& entry : hits) {
+        std::string_view name = index.Name(entry);
+        std::printf("%-6s 0x%016llx %.*s", DumpIndexKindName(entry.kind),
+            static_cast<unsigned long long>(entry.address), static_cast<int>(name.size()), name.data());
+        if (entry.dumpOffset != kDumpIndexNoOffset) {
+            std::printf("  [%s +%llu]", index.header->dumpName, static_cast<unsigned long long>(entry.dumpOffset));
+        }
+        std::printf("\n");
+
+        if (dumpPath && entry.dumpOffset != kDumpIndexNoOffset) {
+            PrintDumpBlock(dumpPath, entry.dumpOffset);
+        }
+    }
+
+    std::fprintf(stderr, "%zu hit(s) in %.3f ms (%u entries indexed)\n", hits.size(), elapsedMs, index.header->entryCount);
+    return hits.empty() ? 2 : 0;
+}
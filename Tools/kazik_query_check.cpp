@@ -0,0 +1,261 @@
+// Self-check for the live query endpoint in Main/Code/query_server.h, over
+// the Unix-socket build of the server.
+//
+// Build: g++ -std=c++17 -O2 -pthread -IMain/Code Tools/kazik_query_check.cpp -o kazik_query_check
+// Usage: kazik_query_check [seed]
+//   Exits 0 when every check passes; prints each failure and exits 1.
+//
+// Serves a generated set of class, field and method records through
+// AnswerRecordQuery, the same path the dumper's AnswerQuery takes, and
+// checks name, addr and range replies against a linear scan, malformed
+// requests, pipelined and concurrent clients, watch streaming, and that
+// Stop returns with clients still connected.
+
+#include "query_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+static int g_failures = 0;
+
+static void Check(bool condition, const std::string& what) {
+    if (condition) return;
+    g_failures++;
+    std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+}
+
+struct Record {
+    std::string type;
+    uint64_t address;
+    std::string className;
+    std::string member;
+};
+
+static std::string RecordText(const Record& record) {
+    LineBuffer line;
+    QueryRecordLine(line, record.type, record.address, record.className, record.member);
+    return std::string(line.data, line.size - 1);
+}
+
+static std::vector<Record> MakeRecords(std::mt19937& rng) {
+    static const char* const kNamespaces[] = { "", "Game", "Game::UI", "UnityEngine" };
+    struct Member { const char* name; bool method; };
+    static const Member kMembers[] = { { "Update", true }, { "get_Health", true }, { "health", false },
+        { "position", false }, { "OnDestroy", true } };
+
+    std::vector<Record> records;
+    for (int c = 0; c < 300; c++) {
+        std::string nameSpace = kNamespaces[rng() % 4];
+        std::string className = (nameSpace.empty() ? "" : nameSpace + "::") + "Class" + std::to_string(c);
+        uint64_t classAddress = 0x7FF600000000ull + (rng() % 100000) * 0x100;
+        records.push_back({ "Class", classAddress, className, "" });
+
+        int members = static_cast<int>(rng() % 4);
+        for (int m = 0; m < members; m++) {
+            const Member& member = kMembers[rng() % 5];
+            uint64_t address = member.method ? 0x7FFA00000000ull + (rng() % 50000) * 0x10 : classAddress + 0x10 + m * 8;
+            records.push_back({ member.method ? "Method" : "Field", address, className, member.name });
+        }
+    }
+    return records;
+}
+
+// Sends one request and reads its reply: record lines, then ". <count>".
+struct Reply {
+    std::vector<std::string> lines;
+    bool bad = false;
+    long count = -1;
+};
+
+static bool ReadReply(QueryChannel& channel, Reply& reply) {
+    std::string line;
+    while (channel.ReadLine(line)) {
+        if (line == "! bad request") {
+            reply.bad = true;
+        }
+        else if (line.size() >= 2 && line[0] == '.' && line[1] == ' ') {
+            reply.count = std::strtol(line.c_str() + 2, nullptr, 10);
+            return true;
+        }
+        else {
+            reply.lines.push_back(line);
+        }
+    }
+    return false;
+}
+
+static Reply Ask(QueryChannel& channel, const std::string& request) {
+    Reply reply;
+    if (channel.Write(request + "\n")) ReadReply(channel, reply);
+    return reply;
+}
+
+static std::vector<std::string> Sorted(std::vector<std::string> lines) {
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+static std::vector<std::string> Expected(const std::vector<Record>& records, const QueryRequest& request) {
+    std::vector<std::string> lines;
+    for (const auto& record : records) {
+        std::string fullName = record.className + (record.member.empty() ? "" : "::" + record.member);
+        bool match = request.kind == kQueryName ? fullName.find(request.text) != std::string::npos :
+            record.address >= request.lo && record.address <= request.hi;
+        if (match) lines.push_back(RecordText(record));
+    }
+    return lines;
+}
+
+static void CheckAnswer(QueryChannel& channel, const std::vector<Record>& records, const std::string& request) {
+    Reply reply = Ask(channel, request);
+    std::vector<std::string> expected = Expected(records, ParseQueryRequest(request));
+    Check(!reply.bad && reply.count == static_cast<long>(reply.lines.size()) &&
+        Sorted(reply.lines) == Sorted(expected), "reply to \"" + request + "\"");
+}
+
+static void CheckParser() {
+    QueryRequest request = ParseQueryRequest("addr 0x10");
+    Check(request.kind == kQueryAddress && request.lo == 16 && request.hi == 16, "parse addr");
+    request = ParseQueryRequest("range 10 0x20");
+    Check(request.kind == kQueryRange && request.lo == 10 && request.hi == 32, "parse range");
+    request = ParseQueryRequest("name Game::UI Class");
+    Check(request.kind == kQueryName && request.text == "Game::UI Class", "parse name with a space");
+    Check(ParseQueryRequest("stats").kind == kQueryStats, "parse stats");
+    Check(ParseQueryRequest("watch").kind == kQueryWatch, "parse watch");
+
+    const char* const bad[] = { "", "name", "name ", "addr", "addr zz", "range 5", "range 9 1", "bogus 1" };
+    for (const char* line : bad) {
+        Check(ParseQueryRequest(line).kind == kQueryInvalid, std::string("\"") + line + "\" is invalid");
+    }
+
+    LineBuffer line;
+    QueryRecordLine(line, "Method", 0x7ffa0010, "Game::Player", "Update");
+    Check(line.View() == "Method 0x7ffa0010 Game::Player::Update\n", "record line format");
+}
+
+template <typename Predicate>
+static bool WaitFor(Predicate&& ready) {
+    for (int i = 0; i < 500 && !ready(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return ready();
+}
+
+static void CheckServer(const std::vector<Record>& records, std::mt19937& rng) {
+    std::string endpoint = "/tmp/kazik_query_check_" + std::to_string(::getpid()) + ".sock";
+    QueryServer server;
+    bool started = server.Start(endpoint, [&](const QueryRequest& request, QueryChannel& channel) -> size_t {
+        if (request.kind == kQueryStats) {
+            LineBuffer line;
+            line << "records " << records.size() << "\ncomplete 1\n";
+            channel.Write(line.View());
+            return 2;
+        }
+        return AnswerRecordQuery(request, channel, [&](auto&& emit) {
+            for (const auto& record : records) emit(record.type, record.address, record.className, record.member);
+        });
+    });
+    Check(started, "listen on " + endpoint);
+    if (!started) return;
+
+    QueryChannel client;
+    Check(client.Connect(endpoint), "connect");
+
+    std::vector<std::string> requests = { "name Class1", "name Game::UI::", "name ::Update", "name Missing",
+        "name get_", "addr 0", "range 0 0xffffffffffffffff" };
+    for (int i = 0; i < 60; i++) {
+        const Record& record = records[rng() % records.size()];
+        requests.push_back("name " + record.className);
+        requests.push_back("addr " + std::to_string(record.address));
+        uint64_t hi = record.address + rng() % 0x40000;
+        requests.push_back("range " + std::to_string(record.address) + " " + std::to_string(hi));
+    }
+    for (const auto& request : requests) CheckAnswer(client, records, request);
+
+    Reply stats = Ask(client, "stats");
+    Check(stats.count == 2 && stats.lines.size() == 2 && stats.lines[0] == "records " + std::to_string(records.size()),
+        "stats reply");
+
+    for (const char* request : { "bogus", "range 9 1", "addr", "" }) {
+        Reply reply = Ask(client, request);
+        Check(reply.bad && reply.count == 0 && reply.lines.empty(), std::string("bad request \"") + request + "\"");
+    }
+
+    // Several requests in one write are answered in order.
+    Check(client.Write("name Class10\nstats\nname Class2\n"), "pipelined write");
+    Reply first, second, third;
+    Check(ReadReply(client, first) && ReadReply(client, second) && ReadReply(client, third) &&
+        Sorted(first.lines) == Sorted(Expected(records, ParseQueryRequest("name Class10"))) &&
+        second.count == 2 &&
+        Sorted(third.lines) == Sorted(Expected(records, ParseQueryRequest("name Class2"))), "pipelined replies");
+
+    std::vector<std::thread> clients;
+    std::vector<int> clientOk(4, 0);
+    for (int c = 0; c < 4; c++) {
+        clients.emplace_back([&, c] {
+            QueryChannel channel;
+            if (!channel.Connect(endpoint)) return;
+            int ok = 0;
+            for (int i = 0; i < 50; i++) {
+                const std::string& request = requests[(c * 50 + i) % requests.size()];
+                Reply reply = Ask(channel, request);
+                ok += Sorted(reply.lines) == Sorted(Expected(records, ParseQueryRequest(request)));
+            }
+            clientOk[c] = ok;
+        });
+    }
+    for (auto& thread : clients) thread.join();
+    for (int c = 0; c < 4; c++) Check(clientOk[c] == 50, "concurrent client " + std::to_string(c));
+
+    // Watchers get every published record, in order.
+    QueryChannel watcher;
+    Check(watcher.Connect(endpoint) && watcher.Write("watch\n"), "start watch");
+    Check(WaitFor([&] { return server.HasWatchers(); }), "watcher registered");
+    std::vector<std::string> published;
+    for (size_t i = 0; i < records.size(); i += 7) {
+        LineBuffer line;
+        QueryRecordLine(line, records[i].type, records[i].address, records[i].className, records[i].member);
+        server.Publish(line.View());
+        published.push_back(RecordText(records[i]));
+    }
+    std::vector<std::string> streamed;
+    std::string line;
+    while (streamed.size() < published.size() && watcher.ReadLine(line)) streamed.push_back(line);
+    Check(streamed == published, "watch stream");
+
+    // Stop returns with an idle client and a watcher still attached, and
+    // both see the hang-up.
+    server.Stop();
+    Check(!client.ReadLine(line) && !watcher.ReadLine(line), "clients see the server stop");
+    Check(::access(endpoint.c_str(), F_OK) != 0, "socket removed on stop");
+}
+
+int main(int argc, char** argv) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    std::mt19937 rng(seed);
+
+    // A wedged server would hang the check instead of failing it.
+    std::thread([] {
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        std::fprintf(stderr, "kazik_query_check: timed out\n");
+        std::_Exit(1);
+    }).detach();
+
+    std::vector<Record> records = MakeRecords(rng);
+    CheckParser();
+    CheckServer(records, rng);
+
+    if (g_failures) {
+        std::fprintf(stderr, "kazik_query_check: %d failures (seed %u)\n", g_failures, seed);
+        return 1;
+    }
+    std::printf("kazik_query_check: ok (seed %u, %zu records)\n", seed, records.size());
+    return 0;
+}